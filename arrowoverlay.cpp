@@ -1,5 +1,7 @@
 #include "arrowoverlay.h"
 #include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
 #include <cmath>
 
 ArrowOverlay::ArrowOverlay(QWidget *parent) : QWidget(parent) {
@@ -10,35 +12,67 @@ ArrowOverlay::ArrowOverlay(QWidget *parent) : QWidget(parent) {
 
 void ArrowOverlay::setArrows(const QList<QPair<QString, QString>> &newArrows,
                              bool flip) {
+  QVector<Arrow> set;
+  set.reserve(newArrows.size());
+  for (const auto &pair : newArrows) {
+    Arrow arrow;
+    arrow.from = pair.first;
+    arrow.to = pair.second;
+    set.append(arrow);
+  }
+  setArrowSet(set, flip);
+}
+
+void ArrowOverlay::setArrowSet(const QVector<Arrow> &newArrows, bool flip) {
+  if (flip != flipped) {
+    flipped = flip;
+    arrows = newArrows;
+    arrowRegion = QRegion();
+    for (const Arrow &arrow : arrows) {
+      if (const CachedArrow *geometry = arrowGeometry(arrow))
+        arrowRegion += geometry->bounds;
+    }
+    update();
+    return;
+  }
+
+  // Only the union of the old and new arrow areas needs repainting.
+  QRegion region;
+  for (const Arrow &arrow : newArrows) {
+    if (const CachedArrow *geometry = arrowGeometry(arrow))
+      region += geometry->bounds;
+  }
+  update(arrowRegion + region);
+  arrowRegion = region;
   arrows = newArrows;
-  flipped = flip;
-  update();
 }
 
 void ArrowOverlay::setHighlights(const QString &from, const QString &to) {
+  QRegion dirty;
+  for (const QString &square : {highlightFrom, highlightTo, from, to})
+    dirty += squareRect(square);
   highlightFrom = from;
   highlightTo = to;
-  update();
+  update(dirty);
 }
 
-QPoint ArrowOverlay::squareToPosition(const QString &square) const {
+QRect ArrowOverlay::squareRect(const QString &square) const {
+  if (square.size() < 2)
+    return QRect();
   int file = square[0].unicode() - 'a';
   int rank = 8 - square[1].digitValue();
-
-
-
   if (flipped) {
     file = 7 - file;
     rank = 7 - rank;
   }
 
-
   qreal tileWidth = static_cast<qreal>(width()) / 8.0;
   qreal tileHeight = static_cast<qreal>(height()) / 8.0;
-  int x = qRound(file * tileWidth);
-  int y = qRound(rank * tileHeight);
-
-  return QPoint(x, y);
+  int left = qRound(file * tileWidth);
+  int top = qRound(rank * tileHeight);
+  int right = qRound((file + 1) * tileWidth);
+  int bottom = qRound((rank + 1) * tileHeight);
+  return QRect(QPoint(left, top), QPoint(right, bottom));
 }
 
 QPoint ArrowOverlay::squareCenter(const QString &square) const {
@@ -58,58 +92,79 @@ QPoint ArrowOverlay::squareCenter(const QString &square) const {
   return QPoint(x, y);
 }
 
-void ArrowOverlay::paintEvent(QPaintEvent *) {
-  QPainter painter(this);
-  painter.setRenderHint(QPainter::Antialiasing);
-
-
-  qreal tileWidth = static_cast<qreal>(width()) / 8.0;
-  qreal tileHeight = static_cast<qreal>(height()) / 8.0;
+const ArrowOverlay::CachedArrow *ArrowOverlay::arrowGeometry(const Arrow &arrow) {
+  if (arrow.from.size() < 2 || arrow.to.size() < 2 || arrow.from == arrow.to)
+    return nullptr;
 
-  auto drawHighlight = [&](const QString &square) {
-    if (square.isEmpty())
-      return;
-    int file = square[0].unicode() - 'a';
-    int rank = 8 - square[1].digitValue();
-    if (flipped) {
-      file = 7 - file;
-      rank = 7 - rank;
-    }
-    int left = qRound(file * tileWidth);
-    int top = qRound(rank * tileHeight);
-    int right = qRound((file + 1) * tileWidth);
-    int bottom = qRound((rank + 1) * tileHeight);
-    QRect rect(QPoint(left, top), QPoint(right, bottom));
-    painter.fillRect(rect, QColor(255, 215, 0, 120));
+  auto index = [](const QString &sq) {
+    return quint32((sq[1].unicode() - '1') * 8 + (sq[0].unicode() - 'a')) & 63;
   };
+  quint32 weightKey = quint32(qBound(1, qRound(arrow.weight * 100), 1023));
+  quint32 key = index(arrow.from) | index(arrow.to) << 6 | weightKey << 12 |
+                quint32(flipped) << 22;
+
+  auto it = pathCache.constFind(key);
+  if (it != pathCache.constEnd())
+    return &it.value();
+
+  // Shaft and head as one filled outline, scaled to the square size.
+  QPointF start = squareCenter(arrow.from);
+  QPointF tip = squareCenter(arrow.to);
+  qreal tile = qMin(width(), height()) / 8.0;
+  qreal shaft = tile * 0.14 * arrow.weight;
+  qreal headLength = tile * 0.38 * arrow.weight;
+  qreal headWidth = tile * 0.24 * arrow.weight;
+
+  QPointF delta = tip - start;
+  qreal length = std::hypot(delta.x(), delta.y());
+  QPointF dir = delta / length;
+  QPointF normal(-dir.y(), dir.x());
+  QPointF neck = tip - dir * qMin(headLength, length * 0.6);
+
+  QPolygonF outline;
+  outline << start + normal * (shaft / 2) << neck + normal * (shaft / 2)
+          << neck + normal * headWidth << tip << neck - normal * headWidth
+          << neck - normal * (shaft / 2) << start - normal * (shaft / 2);
+
+  CachedArrow geometry;
+  geometry.path.setFillRule(Qt::WindingFill);
+  geometry.path.addPolygon(outline);
+  geometry.path.closeSubpath();
+  geometry.path.addEllipse(start, shaft / 2, shaft / 2);
+  geometry.bounds = geometry.path.boundingRect().toAlignedRect().adjusted(-2, -2, 2, 2);
+
+  if (pathCache.size() > 512)
+    pathCache.clear();
+  return &pathCache.insert(key, geometry).value();
+}
 
+void ArrowOverlay::resizeEvent(QResizeEvent *event) {
+  QWidget::resizeEvent(event);
+  pathCache.clear();
+  arrowRegion = QRegion();
+  for (const Arrow &arrow : arrows) {
+    if (const CachedArrow *geometry = arrowGeometry(arrow))
+      arrowRegion += geometry->bounds;
+  }
+}
 
-  drawHighlight(highlightFrom);
-  drawHighlight(highlightTo);
-
-  for (const auto &arrow : arrows) {
-    QPoint fromCenter = squareCenter(arrow.first);
-    QPoint toCenter = squareCenter(arrow.second);
-
-    QPen pen(QColor("#66cc88")); // Teal color
-    pen.setWidth(8);             // Thicker line
-    pen.setCapStyle(Qt::RoundCap);
-    pen.setJoinStyle(Qt::RoundJoin);
-    painter.setPen(pen);
-    painter.drawLine(fromCenter, toCenter);
-
-    double angle = std::atan2(toCenter.y() - fromCenter.y(),
-                              toCenter.x() - fromCenter.x());
-    QPointF arrowP1 = toCenter - QPointF(15 * std::cos(angle - M_PI / 6),
-                                         15 * std::sin(angle - M_PI / 6));
-    QPointF arrowP2 = toCenter - QPointF(15 * std::cos(angle + M_PI / 6),
-                                         15 * std::sin(angle + M_PI / 6));
+void ArrowOverlay::paintEvent(QPaintEvent *) {
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(Qt::NoPen);
 
-    QPolygonF head;
-    head << toCenter << arrowP1 << arrowP2;
-    painter.setBrush(QColor("#66cc88"));
-    painter.drawPolygon(head);
+  for (const QString &square : {highlightFrom, highlightTo}) {
+    if (!square.isEmpty())
+      painter.fillRect(squareRect(square), QColor(255, 215, 0, 120));
   }
 
+  // Drawn weakest first so the best move ends up on top.
+  for (int i = arrows.size() - 1; i >= 0; --i) {
+    if (const CachedArrow *geometry = arrowGeometry(arrows.at(i))) {
+      painter.setBrush(arrows.at(i).color);
+      painter.drawPath(geometry->path);
+    }
+  }
 
+  emit painted(arrows.size());
 }
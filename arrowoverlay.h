@@ -1,24 +1,53 @@
 #pragma once
 
+#include <QColor>
+#include <QHash>
+#include <QPainterPath>
 #include <QPair>
+#include <QRegion>
 #include <QString>
+#include <QVector>
 #include <QWidget>
 
 class ArrowOverlay : public QWidget {
   Q_OBJECT
 public:
+  struct Arrow {
+    QString from;
+    QString to;
+    QColor color = QColor("#66cc88");
+    qreal weight = 1.0; // relative thickness, 1.0 = best move
+  };
+
   explicit ArrowOverlay(QWidget *parent = nullptr);
   void setArrows(const QList<QPair<QString, QString>> &arrows, bool flipped);
+  void setArrowSet(const QVector<Arrow> &arrows, bool flipped);
   void setHighlights(const QString &from, const QString &to);
 
+signals:
+  // Emitted after every paint; lets the latency benchmark timestamp the
+  // moment an arrow actually reaches the screen.
+  void painted(int arrowCount);
+
 protected:
   void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
 
 private:
-  QList<QPair<QString, QString>> arrows;
+  struct CachedArrow {
+    QPainterPath path;
+    QRect bounds;
+  };
+
+  QVector<Arrow> arrows;
   bool flipped = false;
   QString highlightFrom;
   QString highlightTo;
-  QPoint squareToPosition(const QString &square) const;
+  QRegion arrowRegion; // area covered by the arrows currently shown
+  // Outline per (from, to, weight, flip) at the current size; cleared on resize.
+  QHash<quint32, CachedArrow> pathCache;
+
+  const CachedArrow *arrowGeometry(const Arrow &arrow);
   QPoint squareCenter(const QString &square) const;
+  QRect squareRect(const QString &square) const;
 };
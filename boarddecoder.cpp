@@ -0,0 +1,75 @@
+#include "boarddecoder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Half a quantization step: a class the recognizer rounded to zero is
+// unlikely, not impossible.
+const float MinProbability = 0.5f / 255.0f;
+
+double scorePlacement(const double logp[64][13], const uint8_t *placement) {
+    double score = 0.0;
+    for (int sq = 0; sq < 64; ++sq)
+        score += logp[sq][placement[sq]];
+    return score;
+}
+
+} // namespace
+
+void BoardDecoder::fromImageGrid(const unsigned char *quantized, bool flipped,
+                                 SquareProbabilities &out) {
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            int sq = flipped ? row * 8 + (7 - col) : (7 - row) * 8 + col;
+            const unsigned char *cell = quantized + (row * 8 + col) * 13;
+            for (int c = 0; c < 13; ++c)
+                out.p[sq][c] = cell[c] / 255.0f;
+        }
+    }
+}
+
+BoardDecoder::Result BoardDecoder::decode(const ChessPosition &confirmed,
+                                          const SquareProbabilities &probs) {
+    double logp[64][13];
+    double argmaxScore = 0.0;
+    for (int sq = 0; sq < 64; ++sq) {
+        double best = -1e9;
+        for (int c = 0; c < 13; ++c) {
+            logp[sq][c] = std::log(std::max(probs.p[sq][c], MinProbability));
+            best = std::max(best, logp[sq][c]);
+        }
+        argmaxScore += best;
+    }
+
+    Result result;
+    result.unchanged = true;
+    result.position = confirmed;
+    result.logLikelihood = scorePlacement(logp, confirmed.squares());
+
+    // Candidates: no move, any legal move for the side to move and, since the
+    // turn may have been misjudged earlier, any legal move for the other side.
+    ChessPosition pos = confirmed;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1)
+            pos.setSideToMove(pos.sideToMove() == ChessPosition::White ? ChessPosition::Black
+                                                                       : ChessPosition::White);
+        ChessMoveList list;
+        pos.generateLegalMoves(list);
+        for (const ChessMove &m : list) {
+            pos.makeMove(m);
+            double score = scorePlacement(logp, pos.squares());
+            if (score > result.logLikelihood) {
+                result.logLikelihood = score;
+                result.move = m;
+                result.unchanged = false;
+                result.position = pos;
+            }
+            pos.unmakeMove();
+        }
+    }
+
+    result.legal = argmaxScore - result.logLikelihood <= MaxLogLikelihoodGap;
+    return result;
+}
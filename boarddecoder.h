@@ -0,0 +1,37 @@
+#ifndef BOARDDECODER_H
+#define BOARDDECODER_H
+
+#include "chessposition.h"
+
+// Per-square class probabilities from the recognizer, indexed by square
+// (a1 = 0) and by recognizer class / piece code (0 = empty .. 12 = k).
+struct SquareProbabilities {
+    float p[64][13];
+};
+
+// Picks the most likely position reachable from the last confirmed position
+// by at most one legal move, given the recognizer's per-square probabilities.
+class BoardDecoder
+{
+public:
+    struct Result {
+        bool legal = false;       // false: nothing legal fits, use the raw decode
+        bool unchanged = false;   // best fit is the confirmed position itself
+        ChessMove move;           // valid when legal && !unchanged
+        ChessPosition position;   // the decoded position
+        double logLikelihood = 0.0;
+    };
+
+    // How far (in nats) the best legal candidate may fall below the
+    // unconstrained argmax decode before it is rejected as not fitting.
+    static constexpr double MaxLogLikelihoodGap = 8.0;
+
+    // Converts recognizer output (image orientation, row 0 = top of the
+    // capture, 13 quantized probabilities per cell) to square order.
+    static void fromImageGrid(const unsigned char *quantized, bool flipped,
+                              SquareProbabilities &out);
+
+    static Result decode(const ChessPosition &confirmed, const SquareProbabilities &probs);
+};
+
+#endif // BOARDDECODER_H
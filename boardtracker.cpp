@@ -0,0 +1,187 @@
+#include "boardtracker.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int VerifySize = 128;          // 16 px per square
+constexpr double DriftRatio = 0.6;       // of baseline
+constexpr double MinGridScore = 1.5;     // peaks vs. average gradient
+constexpr double SizeTolerance = 0.15;   // square size search range
+
+// Sum of absolute first differences across each column / row.
+void gradientProfiles(const QImage &gray, std::vector<double> &cols, std::vector<double> &rows) {
+  const int w = gray.width();
+  const int h = gray.height();
+  cols.assign(w, 0.0);
+  rows.assign(h, 0.0);
+  const uchar *prev = nullptr;
+  for (int y = 0; y < h; ++y) {
+    const uchar *line = gray.constScanLine(y);
+    double rowSum = 0.0;
+    for (int x = 1; x < w; ++x)
+      cols[x] += std::abs(int(line[x]) - int(line[x - 1]));
+    if (prev) {
+      for (int x = 0; x < w; ++x)
+        rowSum += std::abs(int(line[x]) - int(prev[x]));
+    }
+    rows[y] = rowSum;
+    prev = line;
+  }
+}
+
+double mean(const std::vector<double> &p) {
+  if (p.size() < 2)
+    return 0.0;
+  double sum = 0.0;
+  for (size_t i = 1; i < p.size(); ++i)
+    sum += p[i];
+  return sum / double(p.size() - 1);
+}
+
+// Profile value at i, tolerant to one pixel of rounding.
+double peak(const std::vector<double> &p, int i) {
+  int n = int(p.size());
+  if (i < 1 || i >= n)
+    return 0.0;
+  double v = p[i];
+  if (i > 1)
+    v = std::max(v, p[i - 1]);
+  if (i + 1 < n)
+    v = std::max(v, p[i + 1]);
+  return v;
+}
+
+// Mean of the grid line responses, relative to the profile average.
+double innerGridScore(const std::vector<double> &p) {
+  double avg = mean(p);
+  if (avg <= 0.0)
+    return 0.0;
+  double tile = double(p.size()) / 8.0;
+  double sum = 0.0;
+  for (int k = 1; k < 8; ++k)
+    sum += peak(p, int(std::lround(k * tile)));
+  return sum / 7.0 / avg;
+}
+
+struct AxisFit {
+  int offset = 0;
+  double score = -1.0;
+};
+
+// Best offset for a 9-line lattice with the given spacing.
+AxisFit fitAxis(const std::vector<double> &p, double tile) {
+  AxisFit best;
+  int last = int(p.size()) - int(std::ceil(8 * tile)) - 1;
+  for (int off = 0; off <= last; ++off) {
+    double s = 0.0;
+    for (int k = 0; k <= 8; ++k)
+      s += peak(p, off + int(std::lround(k * tile)));
+    if (s > best.score) {
+      best.score = s;
+      best.offset = off;
+    }
+  }
+  return best;
+}
+
+double frameScore(const QImage &frame) {
+  QImage small = frame.scaled(VerifySize, VerifySize, Qt::IgnoreAspectRatio,
+                              Qt::SmoothTransformation)
+                     .convertToFormat(QImage::Format_Grayscale8);
+  std::vector<double> cols, rows;
+  gradientProfiles(small, cols, rows);
+  return std::min(innerGridScore(cols), innerGridScore(rows));
+}
+
+} // namespace
+
+void BoardTracker::reset(const QRect &region) {
+  current = region;
+  baseline = 0.0;
+  score = 0.0;
+  lowFrames = 0;
+}
+
+BoardTracker::Status BoardTracker::verify(const QImage &frame) {
+  if (current.isNull() || frame.isNull())
+    return Lost;
+
+  score = frameScore(frame);
+
+  if (baseline <= 0.0) {
+    // The region was just chosen, so take it as aligned.
+    baseline = std::max(score, MinGridScore);
+    return Locked;
+  }
+
+  // One low frame can be a move animation or a hover highlight.
+  if (score < baseline * DriftRatio) {
+    if (++lowFrames >= 2)
+      return Drifted;
+  } else {
+    lowFrames = 0;
+  }
+  return Locked;
+}
+
+bool BoardTracker::confirm(const QImage &frame) {
+  if (frame.isNull())
+    return false;
+  score = frameScore(frame);
+  return score >= baseline * DriftRatio;
+}
+
+QRect BoardTracker::searchArea(const QRect &bounds) const {
+  int margin = current.width() / 4;
+  return current.adjusted(-margin, -margin, margin, margin).intersected(bounds);
+}
+
+bool BoardTracker::relocalize(const QImage &areaImage, const QRect &area) {
+  if (areaImage.isNull() || area.isEmpty() || current.isEmpty())
+    return false;
+
+  const QImage gray = areaImage.convertToFormat(QImage::Format_Grayscale8);
+  const double scale = double(gray.width()) / area.width();  // device px per logical px
+  std::vector<double> cols, rows;
+  gradientProfiles(gray, cols, rows);
+  const double colMean = mean(cols);
+  const double rowMean = mean(rows);
+  if (colMean <= 0.0 || rowMean <= 0.0)
+    return false;
+
+  const double tile0 = current.width() * scale / 8.0;
+  double bestScore = -1.0, bestTile = tile0;
+  AxisFit bestX, bestY;
+  for (double tile = tile0 * (1.0 - SizeTolerance); tile <= tile0 * (1.0 + SizeTolerance);
+       tile += 0.25) {
+    AxisFit fx = fitAxis(cols, tile);
+    AxisFit fy = fitAxis(rows, tile);
+    if (fx.score < 0.0 || fy.score < 0.0)
+      continue;
+    double s = fx.score / colMean + fy.score / rowMean;
+    if (s > bestScore) {
+      bestScore = s;
+      bestTile = tile;
+      bestX = fx;
+      bestY = fy;
+    }
+  }
+  if (bestScore < 0.0)
+    return false;
+
+  // Per line and axis; the caller confirms the result on a fresh capture.
+  double normalized = bestScore / 18.0;
+  if (normalized < MinGridScore) {
+    qDebug() << "[tracker] Relocalization failed, score" << normalized;
+    return false;
+  }
+
+  int size = int(std::lround(8 * bestTile / scale));
+  current = QRect(area.x() + int(std::lround(bestX.offset / scale)),
+                  area.y() + int(std::lround(bestY.offset / scale)), size, size);
+  lowFrames = 0;
+  return true;
+}
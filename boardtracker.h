@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <vector>
+
+// Keeps captureRegion locked onto the board between manual selections.
+//
+// verify() checks each captured frame at low resolution: the seven inner
+// grid lines of an aligned board show up as sharp peaks in the column and
+// row gradient profiles. When the peaks fade the board has moved, and
+// relocalize() searches a window around the old region for the offset and
+// square size whose 9 grid lines best match the profiles. Both work on 1-D
+// profiles, so they cost well under the capture itself; only when
+// relocalization fails does the caller need full-screen detection.
+class BoardTracker {
+public:
+  enum Status { Locked, Drifted, Lost };
+
+  void reset(const QRect &region);
+  QRect region() const { return current; }
+
+  // frame: the capture of region(), any resolution.
+  Status verify(const QImage &frame);
+
+  // Screen area to grab for relocalize(): the old region plus a margin.
+  QRect searchArea(const QRect &bounds) const;
+  // areaImage: the capture of area. Updates region() on success.
+  bool relocalize(const QImage &areaImage, const QRect &area);
+  // True if a capture of the (relocalized) region lines up with the grid.
+  bool confirm(const QImage &frame);
+
+  double lastScore() const { return score; }
+
+private:
+  QRect current;
+  double baseline = 0.0; // grid score of the first frame after reset()
+  double score = 0.0;
+  int lowFrames = 0;
+};
@@ -1,8 +1,10 @@
 #include "boardwidget.h"
 #include <QPainter>
 #include <QPixmap>
-#include <QSvgRenderer>
 #include <QResizeEvent>
+#include <QPaintEvent>
+#include <cstring>
+#include "chessposition.h"
 
 BoardWidget::BoardWidget(QWidget *parent) : QWidget(parent) {
 
@@ -12,86 +14,51 @@ BoardWidget::BoardWidget(QWidget *parent) : QWidget(parent) {
   arrowOverlay->show();
 
   setAttribute(Qt::WA_OpaquePaintEvent);
+  updateSquareRects();
+
+  spriteCache = new PieceSpriteCache(QString(), this);
+  connect(spriteCache, &PieceSpriteCache::spritesReady, this,
+          [this](int size, qreal dpr) {
+            if (size == pieceSize() && qFuzzyCompare(dpr, devicePixelRatioF()))
+              update();
+          });
 }
 
-QString BoardWidget::squareToKey(int rank, int file) const {
-  return QString("%1%2").arg(QChar('a' + file)).arg(8 - rank);
+int BoardWidget::pieceSize() const {
+  return qMin(width() / 8, height() / 8);
 }
 
-
-QPoint BoardWidget::squareToPosition(const QString &square,
-                                     bool flipped) const {
-  int file = square[0].unicode() - 'a';  // 0–7
-  int rank = 8 - square[1].digitValue(); // 0–7
-
-
-  if (flipped) {
-    file = 7 - file;
-    rank = 7 - rank;
-  }
-
-
+void BoardWidget::updateSquareRects() {
   int tileW = width() / 8;
   int tileH = height() / 8;
-
-  int x = file * tileW;
-  int y = rank * tileH;
-
-
-  return QPoint(x, y);
-}
-
-void BoardWidget::setPositionFromFen(const QString &fen, bool flipped) {
-  if (fen == currentFen && flipped == currentFlipped)
-    return;
-
-  currentFen = fen;
-  currentFlipped = flipped;
-  parseFen(fen);
-  update();
+  for (int sq = 0; sq < 64; ++sq) {
+    int file = sq % 8;
+    int rank = sq / 8;
+    int col = currentFlipped ? 7 - file : file;
+    int row = currentFlipped ? rank : 7 - rank;
+    squareRects[sq] = QRect(col * tileW, row * tileH, tileW, tileH);
+  }
 }
 
-void BoardWidget::parseFen(const QString &fen) {
-  boardPieces.clear();
+void BoardWidget::setPosition(const PackedPosition &position, bool flipped) {
+  uint8_t next[64];
+  position.unpack(next);
 
-  QStringList parts = fen.split(" ");
-  if (parts.isEmpty())
+  if (flipped != currentFlipped) {
+    currentFlipped = flipped;
+    std::memcpy(pieces, next, sizeof(pieces));
+    updateSquareRects();
+    update();
     return;
-
-  QString board = parts[0];
-
-  int rank = 0, file = 0;
-  for (QChar c : board) {
-    if (c == '/') {
-      rank++;
-      file = 0;
-      continue;
-    }
-
-    if (c.isDigit()) {
-      file += c.digitValue();
-      continue;
-    }
-
-    QString key = squareToKey(rank, file);
-    boardPieces.insert(key, c);
-    file++;
   }
-}
 
-void BoardWidget::preparePiecePixmaps(int size) {
-    piecePixmaps.clear();
-    const QStringList codes = {"wK", "wQ", "wR", "wB", "wN", "wP",
-                                "bK", "bQ", "bR", "bB", "bN", "bP"};
-    for (const QString &code : codes) {
-        QSvgRenderer renderer(QString("assets/pieces/%1.svg").arg(code));
-        QPixmap pix(size, size);
-        pix.fill(Qt::transparent);
-        QPainter p(&pix);
-        renderer.render(&p, QRectF(0, 0, size, size));
-        piecePixmaps.insert(code, pix);
+  // Only squares whose piece changed are repainted.
+  for (int sq = 0; sq < 64; ++sq) {
+    if (pieces[sq] != next[sq]) {
+      pieces[sq] = next[sq];
+      update(squareRects[sq]);
     }
-    cachedPieceSize = size;
+  }
 }
 
 void BoardWidget::paintEvent(QPaintEvent *event) {
@@ -101,26 +68,29 @@ void BoardWidget::paintEvent(QPaintEvent *event) {
 
     int tileW = width() / 8;
     int tileH = height() / 8;
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            QRect square(col * tileW, row * tileH, tileW, tileH);
-            bool light = (row + col) % 2 == 0;
-            painter.fillRect(square, light ? lightSquare : darkSquare);
+    int size = pieceSize();
+    qreal dpr = devicePixelRatioF();
+    if (size != cachedPieceSize || dpr != cachedDpr) {
+        // Until the new sprites arrive the previous ones are drawn scaled.
+        if (spriteCache->sprites(size, dpr, piecePixmaps)) {
+            cachedPieceSize = size;
+            cachedDpr = dpr;
         }
     }
 
-    int pieceSize = qRound(qMin(static_cast<qreal>(tileW), static_cast<qreal>(tileH)));
-    if (pieceSize != cachedPieceSize)
-        preparePiecePixmaps(pieceSize);
-
-    for (auto it = boardPieces.constBegin(); it != boardPieces.constEnd(); ++it) {
-        QString key = it.key();
-        QChar c = it.value();
-        QString code = QString("%1%2").arg(c.isUpper() ? 'w' : 'b').arg(c.toUpper());
-        QPoint pos = squareToPosition(key, currentFlipped);
-        int centeredX = qRound(pos.x() + tileW / 2.0 - pieceSize / 2.0);
-        int centeredY = qRound(pos.y() + tileH / 2.0 - pieceSize / 2.0);
-        painter.drawPixmap(centeredX, centeredY, piecePixmaps.value(code));
+    const QRegion &dirty = event->region();
+    for (int sq = 0; sq < 64; ++sq) {
+        const QRect &square = squareRects[sq];
+        if (!dirty.intersects(square))
+            continue;
+        bool light = ((sq / 8) + (sq % 8)) % 2 == 1;
+        painter.fillRect(square, light ? lightSquare : darkSquare);
+        const QPixmap &pix = piecePixmaps[pieces[sq]];
+        if (pieces[sq] != ChessPosition::NoPiece && !pix.isNull()) {
+            int centeredX = qRound(square.x() + tileW / 2.0 - size / 2.0);
+            int centeredY = qRound(square.y() + tileH / 2.0 - size / 2.0);
+            painter.drawPixmap(QRect(centeredX, centeredY, size, size), pix);
+        }
     }
 }
 
@@ -131,6 +101,13 @@ void BoardWidget::setArrows(const QList<QPair<QString, QString>> &newArrows) {
   }
 }
 
+void BoardWidget::setArrowSet(const QVector<ArrowOverlay::Arrow> &newArrows) {
+  if (arrowOverlay) {
+    arrowOverlay->setArrowSet(newArrows, currentFlipped);
+    arrowOverlay->raise();
+  }
+}
+
 
 QSize BoardWidget::sizeHint() const {
   return QSize(512, 512);
@@ -142,7 +119,7 @@ void BoardWidget::resizeEvent(QResizeEvent *event) {
         arrowOverlay->setGeometry(rect());
         arrowOverlay->raise();
     }
-    cachedPieceSize = -1; // force regeneration of pixmaps
+    updateSquareRects();
     update();
 }
 
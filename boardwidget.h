@@ -1,19 +1,24 @@
 #ifndef BOARDWIDGET_H
 #define BOARDWIDGET_H
 
-#include <QMap>
 #include <QWidget>
 #include <QPixmap>
 #include <QColor>
+#include <QRect>
+#include <cstdint>
 #include "arrowoverlay.h"
+#include "piecespritecache.h"
+#include "packedposition.h"
 
 class BoardWidget : public QWidget {
   Q_OBJECT
 
 public:
   explicit BoardWidget(QWidget *parent = nullptr);
-  void setPositionFromFen(const QString &fen, bool flipped);
+  void setPosition(const PackedPosition &position, bool flipped);
   void setArrows(const QList<QPair<QString, QString>> &newArrows);
+  void setArrowSet(const QVector<ArrowOverlay::Arrow> &newArrows);
+  ArrowOverlay *overlay() const { return arrowOverlay; }
   void paintEvent(QPaintEvent *event) override;
 
 protected:
@@ -22,18 +27,18 @@ protected:
 private:
 
   ArrowOverlay *arrowOverlay = nullptr;
-  QMap<QString, QChar> boardPieces;    // key = square like "e4", value = piece char
-  QMap<QString, QPixmap> piecePixmaps; // cached piece images
-  int cachedPieceSize = -1;
-  QString currentFen;
+  uint8_t pieces[64] = {};      // ChessPosition::Piece codes, a1 = 0
+  QRect squareRects[64];        // widget coordinates for the current size/flip
+  PieceSpriteCache *spriteCache = nullptr;
+  QPixmap piecePixmaps[13];     // indexed by piece code; [0] unused
+  int cachedPieceSize = -1;     // size piecePixmaps were rendered for
+  qreal cachedDpr = 0.0;
   bool currentFlipped = false;
   QColor lightSquare = QColor(240, 217, 181);
   QColor darkSquare = QColor(181, 136, 99);
 
-  QString squareToKey(int rank, int file) const;
-  QPoint squareToPosition(const QString &square, bool flipped) const;
-  void parseFen(const QString &fen);
-  void preparePiecePixmaps(int size);
+  void updateSquareRects();
+  int pieceSize() const;
   QSize sizeHint() const override;
 
 };
@@ -3,76 +3,398 @@
 #include <QDebug>
 #include <QDir>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QtGlobal>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <opencv2/opencv.hpp>
 
-// The previous implementation scanned contours and scored them based on Hough
-// line counts.  It worked reasonably well but often failed on noisy captures.
-// The new approach detects prominent horizontal and vertical lines first and
-// derives the board rectangle directly from their intersections.
+// Detection runs coarse-to-fine on a Gaussian pyramid of the screenshot.
+//
+// On the coarsest level (longest side <= CoarseMaxSide) Canny contours only
+// propose square-ish regions. Each proposal is then scored in parallel by
+// fitting a lattice of 9 equally spaced vertical and 9 horizontal lines to
+// the gradient profiles of its neighbourhood, and must show the alternating
+// light/dark pattern of a board, so large square images and panels no longer
+// win just by being the biggest square on screen. The best lattice is carried
+// down the pyramid, re-fitting every line within a few pixels of its
+// predicted position on each level, and finished with parabolic peak
+// interpolation on the full-resolution image.
 
-QRect detectChessboard(const QImage& qimage) {
+namespace {
+
+constexpr int CoarseMaxSide = 1024;        // longest side of the coarsest level
+constexpr int MinBoardCoarse = 48;         // 6 px per square at the coarsest level
+constexpr size_t MaxCandidates = 48;
+constexpr double SizeTolerance = 0.15;     // lattice size vs. proposal size
+constexpr double MinLatticeScore = 2.0;    // grid line response vs. profile average
+constexpr double MinCheckerContrast = 12.0; // gray levels between light and dark squares
+constexpr int MinCheckerTiles = 48;        // of 64 on the expected side
+
+using Lines = std::array<double, 9>;
+
+// v[j] is the summed absolute difference across the pixel boundary at
+// coordinate origin + j, i.e. between pixels origin + j - 1 and origin + j.
+struct Profile {
+    std::vector<float> v;
+    int origin = 0;
+
+    float at(int c) const {
+        int j = c - origin;
+        return (j >= 0 && j < int(v.size())) ? v[j] : 0.0f;
+    }
+    // Tolerant to one pixel of rounding in the lattice positions.
+    float peak(int c) const { return std::max({at(c - 1), at(c), at(c + 1)}); }
+    double mean() const {
+        if (v.empty())
+            return 0.0;
+        double sum = 0.0;
+        for (float x : v)
+            sum += x;
+        return sum / v.size();
+    }
+};
+
+// Profile across vertical boundaries (vertical == true) or horizontal ones,
+// restricted to roi.
+Profile edgeProfile(const cv::Mat& gray, cv::Rect roi, bool vertical) {
+    Profile p;
+    roi &= cv::Rect(0, 0, gray.cols, gray.rows);
+    if (roi.width < 2 || roi.height < 2)
+        return p;
+
+    cv::Mat f;
+    gray(roi).convertTo(f, CV_32F);
+    cv::Mat diff, sum;
+    if (vertical) {
+        diff = cv::abs(f.colRange(1, f.cols) - f.colRange(0, f.cols - 1));
+        cv::reduce(diff, sum, 0, cv::REDUCE_SUM, CV_32F);
+        p.origin = roi.x + 1;
+    } else {
+        diff = cv::abs(f.rowRange(1, f.rows) - f.rowRange(0, f.rows - 1));
+        cv::reduce(diff, sum, 1, cv::REDUCE_SUM, CV_32F);
+        p.origin = roi.y + 1;
+    }
+    const float* data = sum.ptr<float>();
+    p.v.assign(data, data + sum.total());
+    return p;
+}
+
+struct AxisFit {
+    int offset = 0;
+    double score = -1.0;
+};
+
+// Best position for 9 lines spaced tile apart within the profile.
+AxisFit fitAxis(const Profile& p, double tile) {
+    AxisFit best;
+    int last = p.origin + int(p.v.size()) - 1 - int(std::ceil(8 * tile));
+    for (int off = p.origin; off <= last; ++off) {
+        double s = 0.0;
+        for (int k = 0; k <= 8; ++k)
+            s += p.peak(off + int(std::lround(k * tile)));
+        if (s > best.score) {
+            best.score = s;
+            best.offset = off;
+        }
+    }
+    return best;
+}
+
+// Difference between the light and dark square colours, or 0 if the tiles do
+// not alternate. Samples the inset corners of each square, which pieces
+// rarely cover.
+double checkerContrast(const cv::Mat& gray, double x0, double y0, double tile) {
+    const cv::Rect bounds(0, 0, gray.cols, gray.rows);
+    const int patch = std::max(1, int(tile * 0.2));
+    double values[64];
+    double sums[2] = {0.0, 0.0};
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            double left = x0 + c * tile, top = y0 + r * tile;
+            double inset = tile * 0.1, outset = tile * 0.9 - patch;
+            double v = 0.0;
+            int n = 0;
+            for (double dy : {inset, outset}) {
+                for (double dx : {inset, outset}) {
+                    cv::Rect rect(int(left + dx), int(top + dy), patch, patch);
+                    rect &= bounds;
+                    if (rect.area() > 0) {
+                        v += cv::mean(gray(rect))[0];
+                        ++n;
+                    }
+                }
+            }
+            values[r * 8 + c] = n ? v / n : 0.0;
+            sums[(r + c) % 2] += values[r * 8 + c];
+        }
+    }
+
+    const double light = sums[0] / 32.0;  // the top-left square is light either way up
+    const double dark = sums[1] / 32.0;
+    const double mid = (light + dark) / 2.0;
+    int consistent = 0;
+    for (int i = 0; i < 64; ++i) {
+        bool even = ((i / 8 + i % 8) % 2) == 0;
+        if ((values[i] > mid) == (even == (light > dark)))
+            ++consistent;
+    }
+    return consistent >= MinCheckerTiles ? std::abs(light - dark) : 0.0;
+}
+
+struct Candidate {
+    cv::Rect rect;      // proposal, coarse pixels
+    double x0 = 0.0;    // fitted lattice, coarse pixels
+    double y0 = 0.0;
+    double tile = 0.0;
+    double score = 0.0;
+};
+
+void fitCandidate(const cv::Mat& gray, Candidate& cand) {
+    const double t0 = std::max(cand.rect.width, cand.rect.height) / 8.0;
+    const int margin = int(std::ceil(t0));
+    cv::Rect window(cand.rect.x - margin, cand.rect.y - margin,
+                    cand.rect.width + 2 * margin, cand.rect.height + 2 * margin);
+    Profile cols = edgeProfile(gray, window, true);
+    Profile rows = edgeProfile(gray, window, false);
+    const double colMean = cols.mean();
+    const double rowMean = rows.mean();
+    if (colMean <= 0.0 || rowMean <= 0.0)
+        return;
+
+    double bestScore = 0.0;
+    for (double tile = t0 * (1.0 - SizeTolerance); tile <= t0 * (1.0 + SizeTolerance);
+         tile += 0.25) {
+        AxisFit fx = fitAxis(cols, tile);
+        AxisFit fy = fitAxis(rows, tile);
+        if (fx.score < 0.0 || fy.score < 0.0)
+            continue;
+        // Both axes must line up: one set of rules or table borders is not a board.
+        double s = std::min(fx.score / colMean, fy.score / rowMean) / 9.0;
+        if (s > bestScore) {
+            bestScore = s;
+            cand.x0 = fx.offset;
+            cand.y0 = fy.offset;
+            cand.tile = tile;
+        }
+    }
+    if (bestScore < MinLatticeScore)
+        return;
+    if (checkerContrast(gray, cand.x0, cand.y0, cand.tile) < MinCheckerContrast)
+        return;
+    cand.score = bestScore;
+}
+
+// Sub-pixel position of the strongest boundary within +-radius of expected.
+double refineLine(const Profile& p, double expected, double radius) {
+    int lo = int(std::floor(expected - radius));
+    int hi = int(std::ceil(expected + radius));
+    int best = -1;
+    float bestValue = 0.0f;
+    for (int c = lo; c <= hi; ++c) {
+        if (p.at(c) > bestValue) {
+            bestValue = p.at(c);
+            best = c;
+        }
+    }
+    if (best < 0)
+        return expected;
+
+    double a = p.at(best - 1), b = bestValue, c = p.at(best + 1);
+    double denom = a - 2.0 * b + c;
+    double delta = denom < 0.0 ? 0.5 * (a - c) / denom : 0.0;
+    return best + std::clamp(delta, -0.5, 0.5);
+}
+
+// Lines whose edge was too weak to find (e.g. a board edge that blends into
+// the page) are put back on the least-squares lattice of the others.
+void regularize(Lines& lines) {
+    double sk = 0.0, sx = 0.0, skk = 0.0, skx = 0.0;
+    for (int k = 0; k <= 8; ++k) {
+        sk += k;
+        sx += lines[k];
+        skk += k * k;
+        skx += k * lines[k];
+    }
+    double tile = (9.0 * skx - sk * sx) / (9.0 * skk - sk * sk);
+    double origin = (sx - tile * sk) / 9.0;
+    double tolerance = std::max(1.0, tile * 0.08);
+    for (int k = 0; k <= 8; ++k) {
+        double fitted = origin + k * tile;
+        if (std::abs(lines[k] - fitted) > tolerance)
+            lines[k] = fitted;
+    }
+}
+
+void refineLevel(const cv::Mat& gray, Lines& files, Lines& ranks, double radius) {
+    const int pad = int(std::ceil(radius)) + 2;
+    cv::Rect fileBand(int(std::floor(files[0])) - pad, int(std::floor(ranks[0])),
+                      int(std::ceil(files[8] - files[0])) + 2 * pad,
+                      int(std::ceil(ranks[8] - ranks[0])));
+    cv::Rect rankBand(int(std::floor(files[0])), int(std::floor(ranks[0])) - pad,
+                      int(std::ceil(files[8] - files[0])),
+                      int(std::ceil(ranks[8] - ranks[0])) + 2 * pad);
+    Profile cols = edgeProfile(gray, fileBand, true);
+    Profile rows = edgeProfile(gray, rankBand, false);
+    for (int k = 0; k <= 8; ++k) {
+        files[k] = refineLine(cols, files[k], radius);
+        ranks[k] = refineLine(rows, ranks[k], radius);
+    }
+    regularize(files);
+    regularize(ranks);
+}
+
+double intersectionOverUnion(const cv::Rect& a, const cv::Rect& b) {
+    double inter = (a & b).area();
+    return inter / (a.area() + b.area() - inter);
+}
+
+} // namespace
+
+BoardGeometry detectBoardGeometry(const QImage& qimage) {
     double dpr = qimage.devicePixelRatio();
 
     qDebug() << "[detectChessboard] image size:" << qimage.size() << "dpr" << dpr;
 
     bool debug = qEnvironmentVariableIsSet("CHESSGUI_DEBUG_DETECT");
-    static int debugIndex = 0;
+    static std::atomic<int> debugIndex{0};  // one detection per screen runs at once
     QString baseName;
     if (debug)
         baseName = QString("detect_debug_%1").arg(debugIndex++);
 
-    cv::Mat mat(qimage.height(), qimage.width(), CV_8UC4,
-                const_cast<uchar*>(qimage.bits()), qimage.bytesPerLine());
+    QElapsedTimer timer;
+    timer.start();
 
-    cv::Mat gray;
-    cv::cvtColor(mat, gray, cv::COLOR_BGRA2GRAY);
-    cv::GaussianBlur(gray, gray, cv::Size(3, 3), 0);
+    QImage image = qimage;
+    if (image.format() != QImage::Format_RGB32 && image.format() != QImage::Format_ARGB32
+        && image.format() != QImage::Format_ARGB32_Premultiplied)
+        image = image.convertToFormat(QImage::Format_RGB32);
+    cv::Mat mat(image.height(), image.width(), CV_8UC4,
+                const_cast<uchar*>(image.constBits()), image.bytesPerLine());
 
-    if (debug) {
-        cv::imwrite((baseName + "_gray.png").toStdString(), gray);
+    std::vector<cv::Mat> pyramid(1);
+    cv::cvtColor(mat, pyramid[0], cv::COLOR_BGRA2GRAY);
+    while (std::max(pyramid.back().cols, pyramid.back().rows) > CoarseMaxSide) {
+        cv::Mat down;
+        cv::pyrDown(pyramid.back(), down);
+        pyramid.push_back(down);
     }
+    const int coarse = int(pyramid.size()) - 1;
+    const cv::Mat& coarseGray = pyramid[coarse];
 
-    cv::Mat edges;
-    cv::Canny(gray, edges, 50, 150, 3);
+    cv::Mat blurred, edges;
+    cv::GaussianBlur(coarseGray, blurred, cv::Size(3, 3), 0);
+    cv::Canny(blurred, edges, 50, 150, 3);
+    cv::dilate(edges, edges, cv::Mat());  // close one-pixel gaps in the board outline
 
     if (debug) {
+        cv::imwrite((baseName + "_gray.png").toStdString(), coarseGray);
         cv::imwrite((baseName + "_edges.png").toStdString(), edges);
     }
 
-    // Find external contours
+    // Nested contours too: the board often sits inside a larger panel.
     std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(edges, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-
-    cv::Rect bestRect;
-    double maxArea = 0.0;
+    cv::findContours(edges, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
 
+    std::vector<cv::Rect> proposals;
     for (const auto& contour : contours) {
         cv::Rect rect = cv::boundingRect(contour);
-        double area = rect.area();
         double aspect = static_cast<double>(rect.width) / rect.height;
+        if (aspect > 0.8 && aspect < 1.25 && std::min(rect.width, rect.height) >= MinBoardCoarse)
+            proposals.push_back(rect);
+    }
+    std::sort(proposals.begin(), proposals.end(),
+              [](const cv::Rect& a, const cv::Rect& b) { return a.area() > b.area(); });
 
-        // Heuristic: square-ish and large enough
-        if (area > maxArea && aspect > 0.8 && aspect < 1.2 && area > 10000) {
-            bestRect = rect;
-            maxArea = area;
+    std::vector<Candidate> candidates;
+    for (const cv::Rect& rect : proposals) {
+        bool duplicate = std::any_of(candidates.begin(), candidates.end(), [&](const Candidate& c) {
+            return intersectionOverUnion(c.rect, rect) > 0.9;
+        });
+        if (!duplicate) {
+            candidates.push_back({rect});
+            if (candidates.size() >= MaxCandidates)
+                break;
         }
     }
 
-    if (bestRect.width == 0 || bestRect.height == 0) {
-        qDebug() << "[detectChessboard] no valid board rectangle found";
-        return QRect();
+    cv::parallel_for_(cv::Range(0, int(candidates.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i)
+            fitCandidate(coarseGray, candidates[i]);
+    });
+
+    auto best = std::max_element(candidates.begin(), candidates.end(),
+                                 [](const Candidate& a, const Candidate& b) { return a.score < b.score; });
+    if (best == candidates.end() || best->score <= 0.0) {
+        qDebug() << "[detectChessboard] no board lattice among" << candidates.size()
+                 << "candidates in" << timer.elapsed() << "ms";
+        return BoardGeometry();
+    }
+
+    BoardGeometry geometry;
+    geometry.score = best->score;
+    Lines files, ranks;
+    for (int k = 0; k <= 8; ++k) {
+        files[k] = best->x0 + k * best->tile;
+        ranks[k] = best->y0 + k * best->tile;
+    }
+
+    for (int level = coarse; level >= 0; --level) {
+        double radius = 1.0;
+        if (level < coarse) {
+            // pyrDown keeps the even pixels, so coordinates double around -0.5.
+            for (int k = 0; k <= 8; ++k) {
+                files[k] = 2.0 * files[k] - 0.5;
+                ranks[k] = 2.0 * ranks[k] - 0.5;
+            }
+            radius = std::max(2.0, (files[8] - files[0]) / 8.0 * 0.05);
+        }
+        refineLevel(pyramid[level], files, ranks, radius);
     }
 
     if (debug) {
-        cv::Mat rectImg;
-        cv::cvtColor(mat, rectImg, cv::COLOR_BGRA2BGR);
-        cv::rectangle(rectImg, bestRect, cv::Scalar(0, 255, 0), 2);
-        cv::imwrite((baseName + "_rect.png").toStdString(), rectImg);
+        cv::Mat latticeImg;
+        cv::cvtColor(mat, latticeImg, cv::COLOR_BGRA2BGR);
+        for (int k = 0; k <= 8; ++k) {
+            cv::line(latticeImg, cv::Point(int(std::lround(files[k])), int(std::lround(ranks[0]))),
+                     cv::Point(int(std::lround(files[k])), int(std::lround(ranks[8]))),
+                     cv::Scalar(0, 255, 0), 1);
+            cv::line(latticeImg, cv::Point(int(std::lround(files[0])), int(std::lround(ranks[k]))),
+                     cv::Point(int(std::lround(files[8])), int(std::lround(ranks[k]))),
+                     cv::Scalar(0, 255, 0), 1);
+        }
+        cv::imwrite((baseName + "_lattice.png").toStdString(), latticeImg);
+    }
+
+    for (int k = 0; k <= 8; ++k) {
+        geometry.files[k] = files[k] / dpr;
+        geometry.ranks[k] = ranks[k] / dpr;
+    }
+
+    qDebug() << "[detectChessboard] lattice" << geometry.outerRect() << "score" << geometry.score
+             << "from" << candidates.size() << "candidates in" << timer.elapsed() << "ms";
+    return geometry;
+}
+
+BoardGeometry BoardGeometry::mapped(const QRectF& from, const QRectF& to) const {
+    BoardGeometry out = *this;
+    if (from.width() <= 0 || from.height() <= 0)
+        return out;
+    const double sx = to.width() / from.width();
+    const double sy = to.height() / from.height();
+    for (int k = 0; k <= 8; ++k) {
+        out.files[k] = to.x() + (files[k] - from.x()) * sx;
+        out.ranks[k] = to.y() + (ranks[k] - from.y()) * sy;
     }
+    return out;
+}
 
-    return QRect(bestRect.x / dpr, bestRect.y / dpr, bestRect.width / dpr, bestRect.height / dpr);
+QRect detectChessboard(const QImage& qimage) {
+    BoardGeometry geometry = detectBoardGeometry(qimage);
+    if (!geometry.isValid())
+        return QRect();
 
+    QRectF outer = geometry.outerRect();
+    return QRect(qRound(outer.x()), qRound(outer.y()), qRound(outer.width()), qRound(outer.height()));
 }
@@ -1,5 +1,31 @@
 #pragma once
 #include <QRect>
+#include <QRectF>
 #include <QImage>
+#include <array>
 
+// A detected board in logical (device-independent) pixels of the screenshot.
+// Screen boards are axis-aligned, so the 9x9 lattice of square corners is the
+// cross product of nine vertical and nine horizontal grid lines, each located
+// to sub-pixel precision.
+struct BoardGeometry {
+    std::array<double, 9> files{};  // x of each vertical line, left to right
+    std::array<double, 9> ranks{};  // y of each horizontal line, top to bottom
+    double score = 0.0;             // grid line response vs. its surroundings
+
+    bool isValid() const { return files[8] > files[0] && ranks[8] > ranks[0]; }
+    QRectF outerRect() const {
+        return QRectF(QPointF(files[0], ranks[0]), QPointF(files[8], ranks[8]));
+    }
+    // row 0 is the top of the screenshot, column 0 the left.
+    QRectF squareRect(int row, int col) const {
+        return QRectF(QPointF(files[col], ranks[row]), QPointF(files[col + 1], ranks[row + 1]));
+    }
+    // The same lattice after its board moved and resized from `from` to `to`.
+    BoardGeometry mapped(const QRectF& from, const QRectF& to) const;
+};
+
+BoardGeometry detectBoardGeometry(const QImage& image);
+
+// Outer rect of detectBoardGeometry(), or a null rect if no board was found.
 QRect detectChessboard(const QImage& image);
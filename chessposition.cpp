@@ -0,0 +1,707 @@
+#include "chessposition.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline int lsb(uint64_t b) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, b);
+    return int(idx);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int msb(uint64_t b) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, b);
+    return int(idx);
+#else
+    return 63 - __builtin_clzll(b);
+#endif
+}
+
+inline int popcount(uint64_t b) {
+    int n = 0;
+    for (; b; b &= b - 1)
+        ++n;
+    return n;
+}
+
+inline int popLsb(uint64_t &b) {
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+inline uint64_t bit(int sq) { return uint64_t(1) << sq; }
+
+// Ray directions: the first four increase the square index (scan with lsb),
+// the last four decrease it (scan with msb).
+enum Dir { North, East, NorthEast, NorthWest, South, West, SouthWest, SouthEast };
+
+struct AttackTables {
+    uint64_t knight[64];
+    uint64_t king[64];
+    uint64_t pawn[2][64];
+    uint64_t rays[8][64];
+
+    AttackTables() {
+        static const int df[8] = { 0, 1, 1, -1, 0, -1, -1, 1 };
+        static const int dr[8] = { 1, 0, 1, 1, -1, 0, -1, -1 };
+        for (int sq = 0; sq < 64; ++sq) {
+            int f = sq % 8, r = sq / 8;
+            auto at = [](int ff, int rr) -> uint64_t {
+                return (ff >= 0 && ff < 8 && rr >= 0 && rr < 8) ? bit(rr * 8 + ff) : 0;
+            };
+            knight[sq] = at(f + 1, r + 2) | at(f - 1, r + 2) | at(f + 2, r + 1) | at(f - 2, r + 1)
+                       | at(f + 1, r - 2) | at(f - 1, r - 2) | at(f + 2, r - 1) | at(f - 2, r - 1);
+            king[sq] = at(f + 1, r) | at(f - 1, r) | at(f, r + 1) | at(f, r - 1)
+                     | at(f + 1, r + 1) | at(f - 1, r + 1) | at(f + 1, r - 1) | at(f - 1, r - 1);
+            pawn[ChessPosition::White][sq] = at(f - 1, r + 1) | at(f + 1, r + 1);
+            pawn[ChessPosition::Black][sq] = at(f - 1, r - 1) | at(f + 1, r - 1);
+            for (int d = 0; d < 8; ++d) {
+                uint64_t ray = 0;
+                for (int ff = f + df[d], rr = r + dr[d];
+                     ff >= 0 && ff < 8 && rr >= 0 && rr < 8;
+                     ff += df[d], rr += dr[d])
+                    ray |= bit(rr * 8 + ff);
+                rays[d][sq] = ray;
+            }
+        }
+    }
+};
+
+const AttackTables &tables() {
+    static const AttackTables t;
+    return t;
+}
+
+inline uint64_t rayAttack(int sq, uint64_t occ, int d) {
+    const AttackTables &t = tables();
+    uint64_t attacks = t.rays[d][sq];
+    uint64_t blockers = attacks & occ;
+    if (blockers) {
+        int b = d < South ? lsb(blockers) : msb(blockers);
+        attacks ^= t.rays[d][b];
+    }
+    return attacks;
+}
+
+inline uint64_t rookAttacks(int sq, uint64_t occ) {
+    return rayAttack(sq, occ, North) | rayAttack(sq, occ, East)
+         | rayAttack(sq, occ, South) | rayAttack(sq, occ, West);
+}
+
+inline uint64_t bishopAttacks(int sq, uint64_t occ) {
+    return rayAttack(sq, occ, NorthEast) | rayAttack(sq, occ, NorthWest)
+         | rayAttack(sq, occ, SouthEast) | rayAttack(sq, occ, SouthWest);
+}
+
+const uint64_t Rank1 = 0x00000000000000FFULL;
+const uint64_t Rank8 = 0xFF00000000000000ULL;
+
+// Castling rights that survive a move touching the given square.
+uint8_t castlingMask(int sq) {
+    switch (sq) {
+    case 0:  return uint8_t(~ChessPosition::WhiteQueenSide);
+    case 4:  return uint8_t(~(ChessPosition::WhiteKingSide | ChessPosition::WhiteQueenSide));
+    case 7:  return uint8_t(~ChessPosition::WhiteKingSide);
+    case 56: return uint8_t(~ChessPosition::BlackQueenSide);
+    case 60: return uint8_t(~(ChessPosition::BlackKingSide | ChessPosition::BlackQueenSide));
+    case 63: return uint8_t(~ChessPosition::BlackKingSide);
+    default: return 0xFF;
+    }
+}
+
+} // namespace
+
+ChessPosition::ChessPosition() {
+    clear();
+}
+
+const char *ChessPosition::startFen() {
+    return "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+}
+
+void ChessPosition::clear() {
+    std::memset(pieceBB, 0, sizeof(pieceBB));
+    std::memset(colorBB, 0, sizeof(colorBB));
+    std::memset(board, 0, sizeof(board));
+    side = White;
+    castling = 0;
+    epSquare = NoSquare;
+    halfmove = 0;
+    fullmove = 1;
+    history.clear();
+}
+
+void ChessPosition::putPiece(int sq, uint8_t piece) {
+    board[sq] = piece;
+    pieceBB[piece] |= bit(sq);
+    colorBB[pieceColor(piece)] |= bit(sq);
+}
+
+void ChessPosition::removePiece(int sq) {
+    uint8_t piece = board[sq];
+    board[sq] = NoPiece;
+    pieceBB[piece] &= ~bit(sq);
+    colorBB[pieceColor(piece)] &= ~bit(sq);
+}
+
+void ChessPosition::movePiece(int from, int to) {
+    uint8_t piece = board[from];
+    uint64_t fromTo = bit(from) | bit(to);
+    board[from] = NoPiece;
+    board[to] = piece;
+    pieceBB[piece] ^= fromTo;
+    colorBB[pieceColor(piece)] ^= fromTo;
+}
+
+uint8_t ChessPosition::castlingAfter(uint8_t rights, const ChessMove &m) {
+    return rights & castlingMask(m.from) & castlingMask(m.to);
+}
+
+char ChessPosition::pieceToChar(uint8_t piece) {
+    static const char chars[] = ".PNBRQKpnbrqk";
+    return piece <= BKing ? chars[piece] : '.';
+}
+
+uint8_t ChessPosition::charToPiece(char c) {
+    switch (c) {
+    case 'P': return WPawn;   case 'N': return WKnight; case 'B': return WBishop;
+    case 'R': return WRook;   case 'Q': return WQueen;  case 'K': return WKing;
+    case 'p': return BPawn;   case 'n': return BKnight; case 'b': return BBishop;
+    case 'r': return BRook;   case 'q': return BQueen;  case 'k': return BKing;
+    default:  return NoPiece;
+    }
+}
+
+std::string ChessPosition::squareName(int sq) {
+    if (sq < 0 || sq >= 64)
+        return "-";
+    return std::string{ char('a' + sq % 8), char('1' + sq / 8) };
+}
+
+int ChessPosition::squareFromName(const char *name) {
+    if (!name || name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8')
+        return NoSquare;
+    return (name[1] - '1') * 8 + (name[0] - 'a');
+}
+
+bool ChessPosition::parsePlacement(const std::string &fen, uint8_t out[64]) {
+    std::memset(out, 0, 64);
+    int rank = 7, file = 0;
+    for (char c : fen) {
+        if (c == ' ')
+            break;
+        if (c == '/') {
+            if (file != 8 || rank == 0)
+                return false;
+            --rank;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8)
+                return false;
+        } else {
+            uint8_t piece = charToPiece(c);
+            if (piece == NoPiece || file >= 8)
+                return false;
+            out[rank * 8 + file] = piece;
+            ++file;
+        }
+    }
+    return rank == 0 && file == 8;
+}
+
+bool ChessPosition::setFromFen(const std::string &fen) {
+    std::istringstream in(fen);
+    std::string placement, stm = "w", castle = "-", ep = "-";
+    int half = 0, full = 1;
+    in >> placement >> stm >> castle >> ep >> half >> full;
+
+    uint8_t grid[64];
+    if (!parsePlacement(placement, grid)) {
+        clear();
+        return false;
+    }
+
+    PackedPosition p;
+    p.pack(grid);
+    p.side = (stm == "b") ? Black : White;
+    for (char c : castle) {
+        switch (c) {
+        case 'K': p.castling |= WhiteKingSide;  break;
+        case 'Q': p.castling |= WhiteQueenSide; break;
+        case 'k': p.castling |= BlackKingSide;  break;
+        case 'q': p.castling |= BlackQueenSide; break;
+        default: break;
+        }
+    }
+    p.epSquare = uint8_t(ep.size() == 2 ? squareFromName(ep.c_str()) : NoSquare);
+    p.halfmove = uint16_t(half < 0 ? 0 : half);
+    p.fullmove = uint16_t(full < 1 ? 1 : full);
+    return setFromPacked(p);
+}
+
+bool ChessPosition::setFromPacked(const PackedPosition &p) {
+    clear();
+
+    uint8_t grid[64];
+    p.unpack(grid);
+    for (int sq = 0; sq < 64; ++sq) {
+        if (grid[sq] > BKing) {
+            clear();
+            return false;
+        }
+        if (grid[sq] != NoPiece)
+            putPiece(sq, grid[sq]);
+    }
+    if (popcount(pieceBB[WKing]) != 1 || popcount(pieceBB[BKing]) != 1) {
+        clear();
+        return false;
+    }
+
+    side = p.side == Black ? Black : White;
+    if ((p.castling & WhiteKingSide) && board[4] == WKing && board[7] == WRook)
+        castling |= WhiteKingSide;
+    if ((p.castling & WhiteQueenSide) && board[4] == WKing && board[0] == WRook)
+        castling |= WhiteQueenSide;
+    if ((p.castling & BlackKingSide) && board[60] == BKing && board[63] == BRook)
+        castling |= BlackKingSide;
+    if ((p.castling & BlackQueenSide) && board[60] == BKing && board[56] == BRook)
+        castling |= BlackQueenSide;
+    // Only keep an en passant square that a pawn could actually have skipped.
+    int epSq = p.epSquare;
+    if (epSq < NoSquare) {
+        int pawnSq = side == White ? epSq - 8 : epSq + 8;
+        bool rankOk = side == White ? epSq / 8 == 5 : epSq / 8 == 2;
+        if (rankOk && board[pawnSq] == makePiece(side == White ? Black : White, Pawn))
+            epSquare = uint8_t(epSq);
+    }
+    halfmove = p.halfmove;
+    fullmove = p.fullmove < 1 ? 1 : p.fullmove;
+    return true;
+}
+
+PackedPosition ChessPosition::packed() const {
+    PackedPosition p;
+    p.pack(board);
+    p.side = side;
+    p.castling = castling;
+    p.epSquare = epSquare;
+    p.halfmove = halfmove;
+    p.fullmove = fullmove;
+    return p;
+}
+
+std::string ChessPosition::placementFen() const {
+    std::string out;
+    out.reserve(72);
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            uint8_t piece = board[rank * 8 + file];
+            if (piece == NoPiece) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                out += char('0' + empty);
+                empty = 0;
+            }
+            out += pieceToChar(piece);
+        }
+        if (empty)
+            out += char('0' + empty);
+        if (rank > 0)
+            out += '/';
+    }
+    return out;
+}
+
+std::string ChessPosition::fen() const {
+    std::string out = placementFen();
+    out += side == White ? " w " : " b ";
+    if (castling & WhiteKingSide)  out += 'K';
+    if (castling & WhiteQueenSide) out += 'Q';
+    if (castling & BlackKingSide)  out += 'k';
+    if (castling & BlackQueenSide) out += 'q';
+    if (!castling) out += '-';
+    out += ' ';
+    out += squareName(epSquare);
+    out += ' ' + std::to_string(halfmove) + ' ' + std::to_string(fullmove);
+    return out;
+}
+
+void ChessPosition::setSideToMove(Color c) {
+    if (c == side)
+        return;
+    side = c;
+    epSquare = NoSquare;
+}
+
+int ChessPosition::kingSquare(Color c) const {
+    uint64_t k = pieceBB[makePiece(c, King)];
+    return k ? lsb(k) : NoSquare;
+}
+
+bool ChessPosition::isSquareAttacked(int sq, Color by) const {
+    const AttackTables &t = tables();
+    uint64_t occ = occupancy();
+    Color them = by == White ? Black : White;
+    if (t.pawn[them][sq] & pieceBB[makePiece(by, Pawn)])
+        return true;
+    if (t.knight[sq] & pieceBB[makePiece(by, Knight)])
+        return true;
+    if (t.king[sq] & pieceBB[makePiece(by, King)])
+        return true;
+    uint64_t queens = pieceBB[makePiece(by, Queen)];
+    if (bishopAttacks(sq, occ) & (pieceBB[makePiece(by, Bishop)] | queens))
+        return true;
+    if (rookAttacks(sq, occ) & (pieceBB[makePiece(by, Rook)] | queens))
+        return true;
+    return false;
+}
+
+bool ChessPosition::inCheck() const {
+    int k = kingSquare(side);
+    return k != NoSquare && isSquareAttacked(k, side == White ? Black : White);
+}
+
+void ChessPosition::generatePseudoMoves(ChessMoveList &list) const {
+    const AttackTables &t = tables();
+    const Color us = side;
+    const Color them = us == White ? Black : White;
+    const uint64_t own = colorBB[us];
+    const uint64_t enemy = colorBB[them];
+    const uint64_t occ = own | enemy;
+    const uint64_t empty = ~occ;
+
+    auto addTargets = [&](int from, uint64_t targets) {
+        while (targets) {
+            int to = popLsb(targets);
+            ChessMove m;
+            m.from = uint8_t(from);
+            m.to = uint8_t(to);
+            m.flags = (enemy & bit(to)) ? ChessMove::Capture : ChessMove::Quiet;
+            list.add(m);
+        }
+    };
+    auto addPawnMove = [&](int from, int to, uint8_t flags) {
+        ChessMove m;
+        m.from = uint8_t(from);
+        m.to = uint8_t(to);
+        m.flags = flags;
+        if (bit(to) & (Rank1 | Rank8)) {
+            for (uint8_t promo : { Queen, Rook, Bishop, Knight }) {
+                m.promotion = promo;
+                list.add(m);
+            }
+        } else {
+            list.add(m);
+        }
+    };
+
+    // Pawns
+    const int push = us == White ? 8 : -8;
+    const int startRank = us == White ? 1 : 6;
+    uint64_t pawns = pieceBB[makePiece(us, Pawn)];
+    while (pawns) {
+        int from = popLsb(pawns);
+        int one = from + push;
+        if (empty & bit(one)) {
+            addPawnMove(from, one, ChessMove::Quiet);
+            int two = one + push;
+            if (from / 8 == startRank && (empty & bit(two)))
+                addPawnMove(from, two, ChessMove::DoublePush);
+        }
+        uint64_t caps = t.pawn[us][from] & enemy;
+        while (caps)
+            addPawnMove(from, popLsb(caps), ChessMove::Capture);
+        if (epSquare != NoSquare && (t.pawn[us][from] & bit(epSquare)))
+            addPawnMove(from, epSquare, ChessMove::Capture | ChessMove::EnPassant);
+    }
+
+    // Pieces
+    uint64_t knights = pieceBB[makePiece(us, Knight)];
+    while (knights) {
+        int from = popLsb(knights);
+        addTargets(from, t.knight[from] & ~own);
+    }
+    uint64_t diag = pieceBB[makePiece(us, Bishop)] | pieceBB[makePiece(us, Queen)];
+    while (diag) {
+        int from = popLsb(diag);
+        addTargets(from, bishopAttacks(from, occ) & ~own);
+    }
+    uint64_t ortho = pieceBB[makePiece(us, Rook)] | pieceBB[makePiece(us, Queen)];
+    while (ortho) {
+        int from = popLsb(ortho);
+        addTargets(from, rookAttacks(from, occ) & ~own);
+    }
+    int king = kingSquare(us);
+    if (king == NoSquare)
+        return;
+    addTargets(king, t.king[king] & ~own);
+
+    // Castling: rights imply king and rook are on their home squares.
+    auto addCastle = [&](uint8_t right, int kingFrom, int kingTo, uint64_t between, int pass) {
+        if (!(castling & right) || (occ & between))
+            return;
+        if (isSquareAttacked(kingFrom, them) || isSquareAttacked(pass, them)
+            || isSquareAttacked(kingTo, them))
+            return;
+        ChessMove m;
+        m.from = uint8_t(kingFrom);
+        m.to = uint8_t(kingTo);
+        m.flags = ChessMove::Castle;
+        list.add(m);
+    };
+    if (us == White) {
+        addCastle(WhiteKingSide, 4, 6, bit(5) | bit(6), 5);
+        addCastle(WhiteQueenSide, 4, 2, bit(1) | bit(2) | bit(3), 3);
+    } else {
+        addCastle(BlackKingSide, 60, 62, bit(61) | bit(62), 61);
+        addCastle(BlackQueenSide, 60, 58, bit(57) | bit(58) | bit(59), 59);
+    }
+}
+
+void ChessPosition::generateLegalMoves(ChessMoveList &list) const {
+    ChessMoveList pseudo;
+    generatePseudoMoves(pseudo);
+
+    // make/unmake needs a mutable position; the search below restores it
+    // exactly, so the public API can stay const.
+    ChessPosition &self = const_cast<ChessPosition &>(*this);
+    const Color us = side;
+    const Color them = us == White ? Black : White;
+    list.count = 0;
+    for (const ChessMove &m : pseudo) {
+        self.makeMove(m);
+        int k = kingSquare(us);
+        if (!isSquareAttacked(k, them))
+            list.add(m);
+        self.unmakeMove();
+    }
+}
+
+void ChessPosition::makeMove(const ChessMove &m) {
+    Undo u;
+    u.move = m;
+    u.captured = NoPiece;
+    u.castling = castling;
+    u.epSquare = epSquare;
+    u.halfmove = halfmove;
+
+    const Color us = side;
+    const uint8_t moving = board[m.from];
+    const bool isPawn = pieceType(moving) == Pawn;
+
+    epSquare = NoSquare;
+    if (m.flags & ChessMove::EnPassant) {
+        int capSq = us == White ? m.to - 8 : m.to + 8;
+        u.captured = board[capSq];
+        removePiece(capSq);
+    } else if (board[m.to] != NoPiece) {
+        u.captured = board[m.to];
+        removePiece(m.to);
+    }
+
+    movePiece(m.from, m.to);
+
+    if (m.promotion) {
+        removePiece(m.to);
+        putPiece(m.to, makePiece(us, PieceType(m.promotion)));
+    }
+
+    if (m.flags & ChessMove::Castle) {
+        switch (m.to) {
+        case 6:  movePiece(7, 5);   break;
+        case 2:  movePiece(0, 3);   break;
+        case 62: movePiece(63, 61); break;
+        case 58: movePiece(56, 59); break;
+        default: break;
+        }
+    }
+
+    if (m.flags & ChessMove::DoublePush)
+        epSquare = uint8_t((m.from + m.to) / 2);
+
+    castling = castlingAfter(castling, m);
+    halfmove = (isPawn || u.captured != NoPiece) ? 0 : uint16_t(halfmove + 1);
+    if (us == Black)
+        ++fullmove;
+    side = us == White ? Black : White;
+
+    history.push_back(u);
+}
+
+void ChessPosition::unmakeMove() {
+    if (history.empty())
+        return;
+    Undo u = history.back();
+    history.pop_back();
+    const ChessMove &m = u.move;
+
+    side = side == White ? Black : White;
+    const Color us = side;
+    if (us == Black)
+        --fullmove;
+
+    if (m.flags & ChessMove::Castle) {
+        switch (m.to) {
+        case 6:  movePiece(5, 7);   break;
+        case 2:  movePiece(3, 0);   break;
+        case 62: movePiece(61, 63); break;
+        case 58: movePiece(59, 56); break;
+        default: break;
+        }
+    }
+
+    if (m.promotion) {
+        removePiece(m.to);
+        putPiece(m.to, makePiece(us, Pawn));
+    }
+
+    movePiece(m.to, m.from);
+
+    if (u.captured != NoPiece) {
+        int capSq = m.to;
+        if (m.flags & ChessMove::EnPassant)
+            capSq = us == White ? m.to - 8 : m.to + 8;
+        putPiece(capSq, u.captured);
+    }
+
+    castling = u.castling;
+    epSquare = u.epSquare;
+    halfmove = u.halfmove;
+}
+
+uint64_t ChessPosition::perft(int depth) {
+    if (depth <= 0)
+        return 1;
+    ChessMoveList list;
+    generateLegalMoves(list);
+    if (depth == 1)
+        return uint64_t(list.size());
+    uint64_t nodes = 0;
+    for (const ChessMove &m : list) {
+        makeMove(m);
+        nodes += perft(depth - 1);
+        unmakeMove();
+    }
+    return nodes;
+}
+
+ChessMove ChessPosition::findMoveTo(const uint8_t target[64]) const {
+    ChessMoveList list;
+    generateLegalMoves(list);
+    ChessPosition &self = const_cast<ChessPosition &>(*this);
+    for (const ChessMove &m : list) {
+        self.makeMove(m);
+        bool match = std::memcmp(board, target, 64) == 0;
+        self.unmakeMove();
+        if (match)
+            return m;
+    }
+    return ChessMove();
+}
+
+ChessMove ChessPosition::parseUciMove(const std::string &uci) const {
+    if (uci.size() < 4)
+        return ChessMove();
+    int from = squareFromName(uci.c_str());
+    int to = squareFromName(uci.c_str() + 2);
+    uint8_t promo = 0;
+    if (uci.size() >= 5) {
+        switch (uci[4]) {
+        case 'q': promo = Queen;  break;
+        case 'r': promo = Rook;   break;
+        case 'b': promo = Bishop; break;
+        case 'n': promo = Knight; break;
+        default: break;
+        }
+    }
+    ChessMoveList list;
+    generateLegalMoves(list);
+    for (const ChessMove &m : list) {
+        if (m.from == from && m.to == to && m.promotion == promo)
+            return m;
+    }
+    return ChessMove();
+}
+
+std::string ChessPosition::moveToUci(const ChessMove &m) {
+    if (m.isNull())
+        return std::string();
+    std::string out = squareName(m.from) + squareName(m.to);
+    if (m.promotion)
+        out += "  nbrq"[m.promotion];
+    return out;
+}
+
+std::string ChessPosition::moveToSan(const ChessMove &m) const {
+    if (m.isNull())
+        return std::string();
+
+    std::string out;
+    const PieceType type = pieceType(board[m.from]);
+    if (m.flags & ChessMove::Castle) {
+        out = m.to % 8 == 6 ? "O-O" : "O-O-O";
+    } else {
+        const bool capture = board[m.to] != NoPiece || (m.flags & ChessMove::EnPassant);
+        const std::string from = squareName(m.from);
+        if (type == Pawn) {
+            if (capture)
+                out += from[0];
+        } else {
+            out += pieceToChar(makePiece(White, type));
+            // Disambiguate against other pieces of the same kind that can
+            // reach the square: file if that suffices, else rank, else both.
+            ChessMoveList list;
+            generateLegalMoves(list);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (const ChessMove &o : list) {
+                if (o.to != m.to || o.from == m.from || board[o.from] != board[m.from])
+                    continue;
+                ambiguous = true;
+                sameFile |= o.from % 8 == m.from % 8;
+                sameRank |= o.from / 8 == m.from / 8;
+            }
+            if (ambiguous) {
+                if (!sameFile)
+                    out += from[0];
+                else if (!sameRank)
+                    out += from[1];
+                else
+                    out += from;
+            }
+        }
+        if (capture)
+            out += 'x';
+        out += squareName(m.to);
+        if (m.promotion) {
+            out += '=';
+            out += pieceToChar(makePiece(White, PieceType(m.promotion)));
+        }
+    }
+
+    ChessPosition after(*this);
+    after.makeMove(m);
+    if (after.inCheck()) {
+        ChessMoveList replies;
+        after.generateLegalMoves(replies);
+        out += replies.isEmpty() ? '#' : '+';
+    }
+    return out;
+}
@@ -0,0 +1,149 @@
+#ifndef CHESSPOSITION_H
+#define CHESSPOSITION_H
+
+#include "packedposition.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Squares are numbered a1 = 0, b1 = 1, ... h8 = 63.
+// Piece codes deliberately match the recognizer's class indices
+// (0 = empty, 1..6 = PNBRQK, 7..12 = pnbrqk) so a predicted 8x8 grid can be
+// compared against a position without any translation table.
+
+struct ChessMove {
+    enum Flag : uint8_t {
+        Quiet      = 0,
+        Capture    = 1 << 0,
+        DoublePush = 1 << 1,
+        EnPassant  = 1 << 2,
+        Castle     = 1 << 3
+    };
+
+    uint8_t from = 0;
+    uint8_t to = 0;
+    uint8_t promotion = 0;  // piece type (Knight..Queen) or 0
+    uint8_t flags = Quiet;
+
+    bool isNull() const { return from == to; }
+    bool operator==(const ChessMove &o) const {
+        return from == o.from && to == o.to && promotion == o.promotion;
+    }
+    bool operator!=(const ChessMove &o) const { return !(*this == o); }
+};
+
+struct ChessMoveList {
+    ChessMove moves[256];
+    int count = 0;
+
+    void add(const ChessMove &m) { moves[count++] = m; }
+    const ChessMove *begin() const { return moves; }
+    const ChessMove *end() const { return moves + count; }
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+};
+
+class ChessPosition
+{
+public:
+    enum Color : uint8_t { White = 0, Black = 1 };
+    enum PieceType : uint8_t { NoType = 0, Pawn, Knight, Bishop, Rook, Queen, King };
+    enum Piece : uint8_t {
+        NoPiece = 0,
+        WPawn, WKnight, WBishop, WRook, WQueen, WKing,
+        BPawn, BKnight, BBishop, BRook, BQueen, BKing
+    };
+    enum CastlingRight : uint8_t {
+        WhiteKingSide  = 1,
+        WhiteQueenSide = 2,
+        BlackKingSide  = 4,
+        BlackQueenSide = 8
+    };
+    static constexpr int NoSquare = 64;
+
+    ChessPosition();
+
+    static const char *startFen();
+
+    // Returns false (and leaves the position cleared) if the FEN is malformed.
+    // Missing trailing fields default to "w - - 0 1".
+    bool setFromFen(const std::string &fen);
+    std::string fen() const;
+    std::string placementFen() const;
+
+    PackedPosition packed() const;
+    // Same validation as setFromFen: needs one king per side, keeps only the
+    // castling rights and en passant square the placement allows.
+    bool setFromPacked(const PackedPosition &p);
+
+    uint8_t pieceAt(int sq) const { return board[sq]; }
+    const uint8_t *squares() const { return board; }
+    Color sideToMove() const { return side; }
+    uint8_t castlingRights() const { return castling; }
+    int enPassantSquare() const { return epSquare; }
+    int halfmoveClock() const { return halfmove; }
+    int fullmoveNumber() const { return fullmove; }
+    void setSideToMove(Color c);
+
+    bool inCheck() const;
+    bool isSquareAttacked(int sq, Color by) const;
+
+    void generateLegalMoves(ChessMoveList &list) const;
+    void makeMove(const ChessMove &m);
+    void unmakeMove();
+
+    uint64_t perft(int depth);
+
+    // Finds the legal move that turns this position into the given piece
+    // placement (64 piece codes, a1 first). Returns a null move if none does.
+    ChessMove findMoveTo(const uint8_t target[64]) const;
+    ChessMove parseUciMove(const std::string &uci) const;
+    static std::string moveToUci(const ChessMove &m);
+    // Standard algebraic notation of m, a legal move in this position,
+    // with + or # appended.
+    std::string moveToSan(const ChessMove &m) const;
+
+    static Color pieceColor(uint8_t piece) { return piece >= BPawn ? Black : White; }
+    static PieceType pieceType(uint8_t piece) {
+        return piece == NoPiece ? NoType : PieceType(piece >= BPawn ? piece - 6 : piece);
+    }
+    static uint8_t makePiece(Color c, PieceType t) { return uint8_t(t + (c == Black ? 6 : 0)); }
+    // Castling rights left after m is played with the given rights.
+    static uint8_t castlingAfter(uint8_t rights, const ChessMove &m);
+    static char pieceToChar(uint8_t piece);
+    static uint8_t charToPiece(char c);
+    static std::string squareName(int sq);
+    static int squareFromName(const char *name);
+
+    // Parses the placement field of a FEN (or a full FEN) into 64 piece codes.
+    static bool parsePlacement(const std::string &fen, uint8_t out[64]);
+
+private:
+    struct Undo {
+        ChessMove move;
+        uint8_t captured;
+        uint8_t castling;
+        uint8_t epSquare;
+        uint16_t halfmove;
+    };
+
+    uint64_t pieceBB[13];
+    uint64_t colorBB[2];
+    uint8_t board[64];
+    Color side = White;
+    uint8_t castling = 0;
+    uint8_t epSquare = NoSquare;
+    uint16_t halfmove = 0;
+    uint16_t fullmove = 1;
+    std::vector<Undo> history;
+
+    void clear();
+    void putPiece(int sq, uint8_t piece);
+    void removePiece(int sq);
+    void movePiece(int from, int to);
+    uint64_t occupancy() const { return colorBB[White] | colorBB[Black]; }
+    int kingSquare(Color c) const;
+    void generatePseudoMoves(ChessMoveList &list) const;
+};
+
+#endif // CHESSPOSITION_H
@@ -0,0 +1,259 @@
+#include "enginebackend.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QThread>
+#include <cstdlib>
+#include <cstring>
+
+EngineBackend *EngineBackend::create(Kind kind, const QString &path, QObject *parent) {
+    switch (kind) {
+    case GenericUci:
+        return new UciEngine(path, QStringList(), parent);
+    case Mock:
+        return new UciEngine(defaultPath(Mock), QStringList(), parent);
+    case Stockfish:
+    default:
+        return new StockfishEngine(path, parent);
+    }
+}
+
+QString EngineBackend::kindName(Kind kind) {
+    switch (kind) {
+    case GenericUci: return QStringLiteral("Generic UCI");
+    case Mock:       return QStringLiteral("Mock (testing)");
+    case Stockfish:
+    default:         return QStringLiteral("Stockfish");
+    }
+}
+
+QString EngineBackend::defaultPath(Kind kind) {
+    QString dir = QCoreApplication::applicationDirPath();
+    if (kind == Mock) {
+#ifdef Q_OS_WIN
+        return dir + "/MockUciEngine.exe";
+#else
+        return dir + "/MockUciEngine";
+#endif
+    }
+    return dir + "/stockfish.exe";
+}
+
+UciEngine::UciEngine(const QString &path, const QStringList &arguments, QObject *parent)
+    : EngineBackend(parent), enginePath(path), engineArguments(arguments) {
+    // Reused for every line's pv: with capacity reserved, resize(0) keeps the buffer.
+    info.pv.reserve(1024);
+}
+
+UciEngine::~UciEngine() {
+    stop();
+}
+
+bool UciEngine::start() {
+    stop();
+    stopping = false;
+    searchesInFlight = 0;
+    appliedMultiPv = 1;
+
+    process = new QProcess(this);
+    QProcess *proc = process;
+
+    connect(proc, &QProcess::readyReadStandardOutput, this, &UciEngine::readOutput);
+    connect(proc, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, proc](int, QProcess::ExitStatus exitStatus) {
+                bool crashedNow = proc == process && !stopping &&
+                                  exitStatus == QProcess::CrashExit;
+                if (proc == process)
+                    process = nullptr;
+                proc->deleteLater();
+                if (crashedNow)
+                    emit crashed();
+            });
+
+    proc->start(enginePath, engineArguments);
+    if (!proc->waitForStarted()) {
+        qDebug() << "[engine] Failed to start" << enginePath;
+        process = nullptr;
+        proc->deleteLater();
+        return false;
+    }
+
+    send("uci");
+    return true;
+}
+
+void UciEngine::stop() {
+    if (!process)
+        return;
+    stopping = true;
+    QProcess *proc = process;
+    process = nullptr;
+    if (proc->state() != QProcess::NotRunning) {
+        proc->write("quit\n");
+        if (!proc->waitForFinished(500)) {
+            proc->kill();
+            proc->waitForFinished(3000);
+        }
+    }
+    proc->deleteLater();
+}
+
+bool UciEngine::isRunning() const {
+    return process && process->state() == QProcess::Running;
+}
+
+QString UciEngine::name() const {
+    return engineName.isEmpty() ? enginePath : engineName;
+}
+
+void UciEngine::send(const QByteArray &command) {
+    if (!process)
+        return;
+    process->write(command);
+    process->write("\n");
+}
+
+void UciEngine::setOption(const QString &name, const QString &value) {
+    send(QStringLiteral("setoption name %1 value %2").arg(name, value).toUtf8());
+}
+
+void UciEngine::newGame() {
+    send("ucinewgame");
+}
+
+void UciEngine::setMultiPv(int lines) {
+    // Applied by the next analyse() once the running search is stopped;
+    // UCI forbids changing options mid-search.
+    multiPv = qMax(1, lines);
+}
+
+void UciEngine::analyse(const QString &fen, int depth, const QStringList &searchMoves) {
+    if (!isRunning())
+        return;
+
+    if (searchesInFlight > 0)
+        send("stop");
+    if (multiPv != appliedMultiPv) {
+        setOption(QStringLiteral("MultiPV"), QString::number(multiPv));
+        appliedMultiPv = multiPv;
+    }
+
+    send("position fen " + fen.toUtf8());
+    QByteArray go = "go depth " + QByteArray::number(depth);
+    if (!searchMoves.isEmpty())
+        go += " searchmoves " + searchMoves.join(' ').toUtf8();
+    send(go);
+    ++searchesInFlight;
+}
+
+void UciEngine::readOutput() {
+    if (!process)
+        return;
+
+    while (process && process->canReadLine()) {
+        QByteArray line = process->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        if (line.startsWith("info ")) {
+            // Output of a search we already replaced is stale.
+            if (searchesInFlight <= 1 && parseInfo(line, info))
+                emit infoReceived(info);
+        } else if (line.startsWith("bestmove")) {
+            if (searchesInFlight > 0)
+                --searchesInFlight;
+            if (searchesInFlight == 0) {
+                QByteArray move = line.mid(9);
+                int space = move.indexOf(' ');
+                if (space >= 0)
+                    move.truncate(space);
+                emit bestMoveReceived(QString::fromLatin1(move));
+            }
+        } else if (line == "uciok") {
+            configure();
+            send("isready");
+        } else if (line == "readyok") {
+            emit ready();
+        } else if (line.startsWith("id name ")) {
+            engineName = QString::fromUtf8(line.mid(8));
+        }
+    }
+}
+
+bool UciEngine::parseInfo(const QByteArray &line, EngineInfo &out) {
+    out.depth = 0;
+    out.multipv = 1;
+    out.hasScore = false;
+    out.isMate = false;
+    out.score = 0;
+    out.nodes = 0;
+    out.nps = 0;
+    out.pv.resize(0);
+
+    const char *p = line.constData();
+    const char *end = p + line.size();
+    const char *tok = nullptr;
+    int len = 0;
+
+    // Tokenizes in place; numbers are read with strtoll, which stops at the
+    // following space, and the pv is copied into out.pv's reused buffer, so
+    // no per-token allocation happens.
+    auto next = [&]() -> bool {
+        while (p < end && *p == ' ')
+            ++p;
+        if (p >= end)
+            return false;
+        tok = p;
+        while (p < end && *p != ' ')
+            ++p;
+        len = int(p - tok);
+        return true;
+    };
+    auto is = [&](const char *word) {
+        return int(std::strlen(word)) == len && std::memcmp(tok, word, len) == 0;
+    };
+    auto number = [&]() -> qint64 {
+        return next() ? std::strtoll(tok, nullptr, 10) : 0;
+    };
+
+    if (!next() || !is("info"))
+        return false;
+
+    while (next()) {
+        if (is("depth")) {
+            out.depth = int(number());
+        } else if (is("multipv")) {
+            out.multipv = int(number());
+        } else if (is("score")) {
+            if (!next())
+                break;
+            bool mate = is("mate");
+            if (mate || is("cp")) {
+                out.isMate = mate;
+                out.score = int(number());
+                out.hasScore = true;
+            }
+        } else if (is("nodes")) {
+            out.nodes = number();
+        } else if (is("nps")) {
+            out.nps = number();
+        } else if (is("pv")) {
+            // The moves run to the end of the line.
+            if (next())
+                out.pv.append(tok, int(end - tok));
+            break;
+        } else if (is("string")) {
+            return false;
+        }
+    }
+    return out.depth > 0 || out.hasScore;
+}
+
+StockfishEngine::StockfishEngine(const QString &path, QObject *parent)
+    : UciEngine(path, QStringList(), parent) {}
+
+void StockfishEngine::configure() {
+    // Leave half the cores to screen capture and the recognizer.
+    int threads = qMax(1, QThread::idealThreadCount() / 2);
+    setOption(QStringLiteral("Threads"), QString::number(threads));
+}
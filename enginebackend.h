@@ -0,0 +1,116 @@
+#ifndef ENGINEBACKEND_H
+#define ENGINEBACKEND_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QMetaType>
+
+// One parsed UCI "info" line. Scores are from the side to move's view,
+// exactly as the engine reports them.
+struct EngineInfo {
+    int depth = 0;
+    int multipv = 1;
+    bool hasScore = false;
+    bool isMate = false;
+    int score = 0;          // centipawns, or moves to mate when isMate
+    qint64 nodes = 0;
+    qint64 nps = 0;
+    QByteArray pv;          // UCI moves, space separated, as the engine sent them
+};
+Q_DECLARE_METATYPE(EngineInfo)
+
+// Analysis engine behind the GUI. Backends own their process and UCI
+// conversation and report results through signals, so MainWindow never
+// touches engine I/O directly.
+class EngineBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind { Stockfish = 0, GenericUci = 1, Mock = 2 };
+
+    static EngineBackend *create(Kind kind, const QString &path, QObject *parent = nullptr);
+    static QString kindName(Kind kind);
+    static QString defaultPath(Kind kind);
+
+    explicit EngineBackend(QObject *parent = nullptr) : QObject(parent) {}
+    ~EngineBackend() override = default;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;
+    virtual QString name() const = 0;
+
+    virtual void newGame() = 0;
+    virtual void setMultiPv(int lines) = 0;
+    // Starts analysing fen; a search still running is stopped and its
+    // remaining output is dropped, so results always belong to the last call.
+    virtual void analyse(const QString &fen, int depth,
+                         const QStringList &searchMoves = QStringList()) = 0;
+
+signals:
+    void ready();
+    void infoReceived(const EngineInfo &info);
+    void bestMoveReceived(const QString &move);
+    void crashed();
+};
+
+// Any engine speaking UCI over stdin/stdout.
+class UciEngine : public EngineBackend
+{
+    Q_OBJECT
+
+public:
+    explicit UciEngine(const QString &path, const QStringList &arguments = QStringList(),
+                       QObject *parent = nullptr);
+    ~UciEngine() override;
+
+    bool start() override;
+    void stop() override;
+    bool isRunning() const override;
+    QString name() const override;
+
+    void newGame() override;
+    void setMultiPv(int lines) override;
+    void analyse(const QString &fen, int depth, const QStringList &searchMoves) override;
+
+    void setOption(const QString &name, const QString &value);
+
+    // Parses a single "info" line; returns false if it carries no search data.
+    static bool parseInfo(const QByteArray &line, EngineInfo &info);
+
+protected:
+    // Hook for backends that configure the engine once "uciok" arrives.
+    virtual void configure() {}
+    void send(const QByteArray &command);
+
+private slots:
+    void readOutput();
+
+private:
+    QString enginePath;
+    QStringList engineArguments;
+    QProcess *process = nullptr;
+    QString engineName;
+    int multiPv = 1;
+    int appliedMultiPv = 1;
+    int searchesInFlight = 0;
+    bool stopping = false;
+    EngineInfo info;
+};
+
+// Stockfish with the options this GUI expects.
+class StockfishEngine : public UciEngine
+{
+    Q_OBJECT
+
+public:
+    explicit StockfishEngine(const QString &path, QObject *parent = nullptr);
+
+protected:
+    void configure() override;
+};
+
+#endif // ENGINEBACKEND_H
@@ -0,0 +1,74 @@
+#include "enginestatemodel.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimer>
+#include <cmath>
+
+EngineStateModel::EngineStateModel(QObject *parent)
+    : QObject(parent)
+{
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(frameTimer, &QTimer::timeout, this, &EngineStateModel::publish);
+    pvText.reserve(1024);
+    setRefreshRate(0);
+}
+
+void EngineStateModel::setRefreshRate(int hz) {
+    if (hz <= 0) {
+        QScreen *screen = QGuiApplication::primaryScreen();
+        qreal rate = screen ? screen->refreshRate() : 60.0;
+        hz = rate >= 1.0 ? int(std::lround(rate)) : 60;
+    }
+    intervalMs = qMax(1, 1000 / hz);
+}
+
+void EngineStateModel::reset() {
+    frameTimer->stop();
+    dirty = false;
+    pvChanged = false;
+    current = EngineSnapshot();
+    emit snapshotChanged(current);
+}
+
+void EngineStateModel::updateFromInfo(const EngineInfo &info, bool blackToMove) {
+    // Secondary lines carry no eval for the display, but still mark the
+    // state dirty so PV arrows are refreshed on the next frame.
+    if (info.multipv == 1) {
+        int povSign = blackToMove ? -1 : 1;
+        current.hasScore = info.hasScore;
+        current.isMate = info.isMate;
+        current.whiteScore = povSign * info.score;
+        current.depth = info.depth;
+        current.nodes = info.nodes;
+        current.nps = info.nps;
+        if (!info.pv.isEmpty()) {
+            // Copied, not shared, so the parser's buffer stays reusable.
+            pvText.resize(0);
+            pvText.append(info.pv.constData(), info.pv.size());
+            pvChanged = true;
+        }
+    }
+    dirty = true;
+
+    if (frameTimer->isActive())
+        return;
+    qint64 wait = sincePublish.isValid() ? intervalMs - sincePublish.elapsed() : 0;
+    if (wait <= 0)
+        publish();
+    else
+        frameTimer->start(int(wait));
+}
+
+void EngineStateModel::publish() {
+    if (!dirty)
+        return;
+    dirty = false;
+    if (pvChanged) {
+        current.pv = QString::fromLatin1(pvText).split(' ', Qt::SkipEmptyParts);
+        pvChanged = false;
+    }
+    sincePublish.restart();
+    emit snapshotChanged(current);
+}
@@ -0,0 +1,56 @@
+#ifndef ENGINESTATEMODEL_H
+#define ENGINESTATEMODEL_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include "enginebackend.h"
+
+// Latest analysis state, re-oriented to White's point of view.
+struct EngineSnapshot {
+    bool hasScore = false;
+    bool isMate = false;
+    int whiteScore = 0;     // centipawns, or moves to mate when isMate
+    int depth = 0;
+    qint64 nodes = 0;
+    qint64 nps = 0;
+    QStringList pv;         // principal variation (MultiPV line 1), as of the last publish
+};
+
+class QTimer;
+
+// Collects engine output as fast as it arrives and republishes it at most
+// once per display frame. The first update after a quiet period goes out
+// immediately so a fresh result isn't delayed; bursts after that are folded
+// into one snapshotChanged() per frame carrying only the newest state.
+class EngineStateModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EngineStateModel(QObject *parent = nullptr);
+
+    // Updates per second; 0 follows the primary screen's refresh rate.
+    void setRefreshRate(int hz);
+    int refreshInterval() const { return intervalMs; }
+
+    void reset();
+    void updateFromInfo(const EngineInfo &info, bool blackToMove);
+    const EngineSnapshot &snapshot() const { return current; }
+
+signals:
+    void snapshotChanged(const EngineSnapshot &snapshot);
+
+private:
+    void publish();
+
+    EngineSnapshot current;
+    QByteArray pvText;      // line 1's pv, split into current.pv at publish
+    bool pvChanged = false;
+    bool dirty = false;
+    int intervalMs = 16;
+    QTimer *frameTimer = nullptr;
+    QElapsedTimer sincePublish;
+};
+
+#endif // ENGINESTATEMODEL_H
@@ -0,0 +1,153 @@
+#include "evalgraphwidget.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QPaintEvent>
+
+EvalGraphWidget::EvalGraphWidget(QWidget *parent) : QWidget(parent) {
+  setAttribute(Qt::WA_OpaquePaintEvent);
+  setMinimumHeight(48);
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+QSize EvalGraphWidget::sizeHint() const { return QSize(512, 80); }
+
+void EvalGraphWidget::addSample(int whiteScore) {
+  qint16 v = qint16(qBound(-Limit, whiteScore, Limit));
+  if (samples.size() == Capacity)
+    dropOldestHalf();
+  samples.append(v);
+
+  const int n = samples.size();
+  if (n % 2 != 0) {
+    update();
+    return;
+  }
+  if (levels.isEmpty())
+    levels.append(Level());
+  levels[0].mins.append(qMin(samples[n - 2], samples[n - 1]));
+  levels[0].maxs.append(qMax(samples[n - 2], samples[n - 1]));
+
+  // Each completed pair at level k produces one entry at level k + 1.
+  for (int k = 0; levels[k].mins.size() % 2 == 0; ++k) {
+    if (levels.size() == k + 1)
+      levels.append(Level());
+    const Level &lower = levels[k];
+    int n = lower.mins.size();
+    qint16 lo = qMin(lower.mins[n - 2], lower.mins[n - 1]);
+    qint16 hi = qMax(lower.maxs[n - 2], lower.maxs[n - 1]);
+    levels[k + 1].mins.append(lo);
+    levels[k + 1].maxs.append(hi);
+  }
+  update();
+}
+
+// Capacity is a power of two, so the remaining samples start on a block
+// boundary at every level that still has whole blocks left.
+void EvalGraphWidget::dropOldestHalf() {
+  const int drop = Capacity / 2;
+  samples.remove(0, drop);
+  for (int k = 0; k < levels.size(); ++k) {
+    const int block = 2 << k;
+    if (block > drop) {
+      levels.resize(k);
+      break;
+    }
+    levels[k].mins.remove(0, drop / block);
+    levels[k].maxs.remove(0, drop / block);
+  }
+
+  int kept = 0;
+  for (int start : plyStarts) {
+    if (start >= drop)
+      plyStarts[kept++] = start - drop;
+  }
+  plyStarts.resize(kept);
+}
+
+void EvalGraphWidget::markPly() {
+  int next = sampleCount();
+  if (plyStarts.isEmpty() || plyStarts.last() != next)
+    plyStarts.append(next);
+}
+
+void EvalGraphWidget::clear() {
+  samples.clear();
+  levels.clear();
+  plyStarts.clear();
+  update();
+}
+
+void EvalGraphWidget::rangeMinMax(int begin, int end, int &lo, int &hi) const {
+  lo = Limit;
+  hi = -Limit;
+  // Cover [begin, end) with the largest aligned blocks available; blocks
+  // of 2^t samples are samples itself for t = 0, levels[t - 1] above.
+  while (begin < end) {
+    int t = 0;
+    while (t < levels.size() && (begin & ((2 << t) - 1)) == 0 &&
+           begin + (2 << t) <= end && (begin >> (t + 1)) < levels[t].mins.size())
+      ++t;
+    if (t == 0) {
+      lo = qMin(lo, int(samples[begin]));
+      hi = qMax(hi, int(samples[begin]));
+    } else {
+      int block = begin >> t;
+      lo = qMin(lo, int(levels[t - 1].mins[block]));
+      hi = qMax(hi, int(levels[t - 1].maxs[block]));
+    }
+    begin += 1 << t;
+  }
+}
+
+void EvalGraphWidget::paintEvent(QPaintEvent *) {
+  QPainter painter(this);
+  painter.fillRect(rect(), QColor("#2A2A2A"));
+
+  const int w = width();
+  const int h = height();
+  auto yFor = [h](int v) {
+    return (h - 1) * (Limit - v) / (2.0 * Limit);
+  };
+
+  painter.setPen(QColor(90, 90, 90));
+  painter.drawLine(0, qRound(yFor(0)), w, qRound(yFor(0)));
+
+  const int n = sampleCount();
+  if (n == 0)
+    return;
+
+  // Ply boundaries, only while they are far enough apart to read.
+  if (n > 1 && plyStarts.size() > 1 && w * 1.0 / plyStarts.size() >= 6.0) {
+    painter.setPen(QColor(60, 60, 60));
+    for (int start : plyStarts) {
+      int x = qRound(start * (w - 1.0) / (n - 1));
+      painter.drawLine(x, 0, x, h);
+    }
+  }
+
+  QColor lineColor("#66cc88");
+  if (n <= w) {
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(lineColor, 1.5));
+    QPainterPath path;
+    for (int i = 0; i < n; ++i) {
+      QPointF p(n == 1 ? 0.0 : i * (w - 1.0) / (n - 1), yFor(samples[i]));
+      if (i == 0)
+        path.moveTo(p);
+      else
+        path.lineTo(p);
+    }
+    painter.drawPath(path);
+    return;
+  }
+
+  // More samples than pixels: one min/max bar per column.
+  painter.setPen(lineColor);
+  for (int x = 0; x < w; ++x) {
+    int begin = int(qint64(x) * n / w);
+    int end = qMax(begin + 1, int(qint64(x + 1) * n / w));
+    int lo, hi;
+    rangeMinMax(begin, end, lo, hi);
+    painter.drawLine(x, qRound(yFor(hi)), x, qRound(yFor(lo)));
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef EVALGRAPHWIDGET_H
+#define EVALGRAPHWIDGET_H
+
+#include <QVector>
+#include <QWidget>
+
+// Evaluation over the session, one sample per engine update (intermediate
+// depths included), White's point of view.
+//
+// Samples are stored once as int16 and summarized in a min/max pyramid
+// (levels[k] holds min/max over aligned blocks of 2^(k+1) samples), so a
+// paint costs O(width * log n) however long the session has run. At
+// Capacity samples the oldest half is dropped, which keeps every block
+// aligned, so memory stays bounded at about 6 bytes per sample of Capacity.
+class EvalGraphWidget : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit EvalGraphWidget(QWidget *parent = nullptr);
+
+  // Centipawns from White's view; mate scores should be passed as +-Limit.
+  void addSample(int whiteScore);
+  // Marks the start of a new position (a ply) at the next sample.
+  void markPly();
+  void clear();
+
+  int sampleCount() const { return samples.size(); }
+
+  static constexpr int Limit = 1000;
+  // Hours of engine updates at typical rates; must be a power of two.
+  static constexpr int Capacity = 1 << 20;
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  QSize sizeHint() const override;
+
+private:
+  struct Level {
+    QVector<qint16> mins;
+    QVector<qint16> maxs;
+  };
+
+  QVector<qint16> samples;    // raw, oldest first
+  QVector<Level> levels;      // [0] = pairs of samples
+  QVector<int> plyStarts;     // sample index of each ply's first sample
+
+  void dropOldestHalf();
+  void rangeMinMax(int begin, int end, int &lo, int &hi) const;
+};
+
+#endif // EVALGRAPHWIDGET_H
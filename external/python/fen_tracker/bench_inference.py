@@ -0,0 +1,88 @@
+# bench_inference.py
+#
+# Frames per second of the recognizer, original path vs. the optimized one
+# in core/inference.py, on the same frames and thread count. Also checks
+# that both produce the same boards.
+#
+#   python bench_inference.py [--model ccn_model_default.pth] [--frames 200]
+#                             [--threads N] [--image move_00.png]
+
+import argparse
+import os
+import time
+
+import numpy as np
+import torch
+import torch.nn.functional as F
+from PIL import Image
+from torchvision import transforms
+
+from core.inference import configure_threads, default_threads, optimize, predict_board, to_tensor
+from core.model_registry import load_ccn
+
+
+def legacy_predict(model, transform, image):
+    """The path main.py used before: PIL -> Resize + ToTensor, eval() and no_grad per frame."""
+    tensor = transform(image)
+    model.eval()
+    with torch.no_grad():
+        out = model(tensor.unsqueeze(0))
+        probs = F.softmax(out, dim=-1).squeeze(0)
+        pred = probs.argmax(dim=-1)
+    return pred.cpu().numpy(), probs.cpu().numpy()
+
+
+def frames_per_second(fn, frames, repeats):
+    fn(frames[0])  # not timed
+    start = time.perf_counter()
+    for i in range(repeats):
+        fn(frames[i % len(frames)])
+    return repeats / (time.perf_counter() - start)
+
+
+def main():
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--model", default=os.path.join(script_dir, "ccn_model_default.pth"))
+    parser.add_argument("--image", default=os.path.join(script_dir, "move_00.png"))
+    parser.add_argument("--frames", type=int, default=200)
+    parser.add_argument("--threads", type=int, default=default_threads())
+    args = parser.parse_args()
+
+    configure_threads(args.threads)
+    base = Image.open(args.image).convert("RGB").resize((256, 256))
+    # A few distinct frames so no path benefits from identical inputs.
+    rng = np.random.default_rng(0)
+    arrays = [np.array(base)]
+    for _ in range(7):
+        noise = rng.integers(-3, 4, size=arrays[0].shape)
+        arrays.append(np.clip(arrays[0].astype(np.int16) + noise, 0, 255).astype(np.uint8))
+    images = [Image.fromarray(a) for a in arrays]
+
+    eager = load_ccn(args.model)
+    transform = transforms.Compose([transforms.Resize((256, 256)), transforms.ToTensor()])
+    legacy_fps = frames_per_second(lambda im: legacy_predict(eager, transform, im), images, args.frames)
+
+    start = time.perf_counter()
+    fast = optimize(load_ccn(args.model))
+    prepare_ms = (time.perf_counter() - start) * 1000
+    fast_fps = frames_per_second(lambda a: predict_board(fast, to_tensor(a)), arrays, args.frames)
+
+    mismatched = 0
+    max_diff = 0.0
+    for image, array in zip(images, arrays):
+        board_a, probs_a = legacy_predict(eager, transform, image)
+        board_b, probs_b = predict_board(fast, to_tensor(array))
+        mismatched += int((board_a != board_b).sum())
+        max_diff = max(max_diff, float(np.abs(probs_a - probs_b).max()))
+
+    print(f"threads {args.threads}, {args.frames} frames, torch {torch.__version__}")
+    print(f"  legacy     {legacy_fps:7.1f} frames/s  ({1000 / legacy_fps:.2f} ms/frame)")
+    print(f"  optimized  {fast_fps:7.1f} frames/s  ({1000 / fast_fps:.2f} ms/frame), "
+          f"{fast_fps / legacy_fps:.2f}x, prepared in {prepare_ms:.0f} ms incl. warm-up")
+    print(f"  agreement  {mismatched} of {64 * len(arrays)} squares differ, "
+          f"max probability difference {max_diff:.2e}")
+
+
+if __name__ == "__main__":
+    main()
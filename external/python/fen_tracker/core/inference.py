@@ -0,0 +1,87 @@
+# core/inference.py
+#
+# Inference path of the recognizer. Models are prepared once when the
+# registry loads them: traced to TorchScript, frozen (which folds BatchNorm
+# into the convolutions), optimized for inference, switched to channels-last
+# and warmed up. Frames go straight from the uint8 capture to a channels-last
+# tensor without PIL or torchvision, and run under inference_mode. The
+# intra-op thread count is set explicitly so the recognizer leaves cores to
+# the engine.
+
+import os
+
+import numpy as np
+import torch
+import torch.nn.functional as F
+
+INPUT_SIZE = 256
+WARMUP_RUNS = 3
+
+
+def default_threads():
+    """A quarter of the cores, at least one; the rest belong to the engine."""
+    return max(1, (os.cpu_count() or 4) // 4)
+
+
+def configure_threads(threads):
+    torch.set_num_threads(max(1, threads))
+    try:
+        torch.set_num_interop_threads(1)
+    except RuntimeError:
+        pass  # only settable before the first parallel op; keep what is there
+
+
+def to_tensor(image_array):
+    """H x W x 3 uint8 RGB -> [1, 3, 256, 256] float32 in [0, 1], channels-last.
+
+    Same values as transforms.Resize((256, 256)) + ToTensor() on a 256x256
+    capture; other sizes are resized with antialiased bilinear filtering.
+    """
+    # The HWC buffer permuted to NCHW already has channels-last strides.
+    t = torch.from_numpy(np.ascontiguousarray(image_array[:, :, :3])).permute(2, 0, 1).unsqueeze(0)
+    t = t.to(torch.float32).div_(255.0)
+    if t.shape[-2:] != (INPUT_SIZE, INPUT_SIZE):
+        t = F.interpolate(t, size=(INPUT_SIZE, INPUT_SIZE), mode="bilinear",
+                          align_corners=False, antialias=True)
+    return t.contiguous(memory_format=torch.channels_last)
+
+
+def optimize(model):
+    """Eager CCN -> frozen channels-last TorchScript module, warmed up.
+
+    Falls back to the eager model (still channels-last) if tracing fails.
+    Models that are already TorchScript (int8 archives from
+    core/quantization.py) are only warmed up.
+    """
+    model.eval()
+    if isinstance(model, torch.jit.ScriptModule):
+        warm_up(model)
+        return model
+    model = model.to(memory_format=torch.channels_last)
+    example = torch.zeros(1, 3, INPUT_SIZE, INPUT_SIZE).contiguous(memory_format=torch.channels_last)
+    try:
+        with torch.no_grad():
+            traced = torch.jit.trace(model, example)
+            prepared = torch.jit.optimize_for_inference(torch.jit.freeze(traced))
+    except Exception as e:
+        print(f"[inference] TorchScript unavailable ({e}), using the eager model", flush=True)
+        prepared = model
+    warm_up(prepared)
+    return prepared
+
+
+def warm_up(model, runs=WARMUP_RUNS):
+    """First calls pay for kernel selection and allocation; do it before frames arrive."""
+    example = torch.zeros(1, 3, INPUT_SIZE, INPUT_SIZE).contiguous(memory_format=torch.channels_last)
+    with torch.inference_mode():
+        for _ in range(runs):
+            model(example)
+
+
+def predict_board(model, image_tensor):
+    """Return (argmax board [8, 8], softmax probabilities [8, 8, 13])."""
+    with torch.inference_mode():
+        out = model(image_tensor)  # [1, 8, 8, 13]
+        probs = F.softmax(out, dim=-1).squeeze(0)  # [8, 8, 13]
+        pred = probs.argmax(dim=-1)  # [8, 8]
+    return pred.numpy(), probs.numpy()
@@ -0,0 +1,234 @@
+# core/model_registry.py
+#
+# Several CCN weight files, each tagged with the colour fingerprint of the
+# board theme it was trained on. The fingerprint of the captured board is
+# computed once per capture region and picks the closest model; weights are
+# loaded on first use and kept in an LRU bounded by their tensor size.
+#
+# --model accepts a weight file (registry of one), a models.json manifest or
+# a directory holding one:
+#
+#   {"models": [
+#       {"name": "lichess-brown", "path": "ccn_lichess_brown.pth",
+#        "fingerprint": [...], "default": true},
+#       ...
+#   ]}
+#
+# Paths are relative to the manifest. Entries are added with
+#   python -m core.model_registry add models.json weights.pth board.png [--name N]
+# where board.png is a capture of a board in that theme.
+
+import argparse
+import json
+import os
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Optional
+
+import numpy as np
+
+MANIFEST_NAME = "models.json"
+HIST_BINS = 4            # per channel, so 64 bins per square colour
+MAX_DISTANCE = 0.6       # beyond this no model matches and the default is used
+DEFAULT_CACHE_MB = 256
+
+
+def theme_fingerprint(image_array):
+    """Light and dark square colour histograms of a board image.
+
+    image_array is H x W x 3 uint8. Only the inset corners of each square are
+    sampled, since pieces rarely cover them. Returns 2 * HIST_BINS**3 float32
+    values, the light square histogram first, each half summing to 1.
+    """
+    h, w = image_array.shape[:2]
+    th, tw = h // 8, w // 8
+    tiles = image_array[:th * 8, :tw * 8, :3].reshape(8, th, 8, tw, 3).transpose(0, 2, 1, 3, 4)
+    ph, pw = max(1, th // 5), max(1, tw // 5)
+    rows = (th // 10, th - th // 10 - ph)
+    cols = (tw // 10, tw - tw // 10 - pw)
+    patches = np.concatenate(
+        [tiles[:, :, r:r + ph, c:c + pw].reshape(8, 8, -1, 3) for r in rows for c in cols], axis=2)
+
+    odd = (np.add.outer(np.arange(8), np.arange(8)) % 2).astype(bool)
+    light = patches[~odd].reshape(-1, 3)
+    dark = patches[odd].reshape(-1, 3)
+    if light.mean() < dark.mean():
+        light, dark = dark, light
+    return np.concatenate([_histogram(light), _histogram(dark)])
+
+
+def _histogram(pixels):
+    q = (pixels.astype(np.int32) * HIST_BINS) >> 8
+    idx = (q[:, 0] * HIST_BINS + q[:, 1]) * HIST_BINS + q[:, 2]
+    hist = np.bincount(idx, minlength=HIST_BINS ** 3).astype(np.float32)
+    return hist / max(1, len(pixels))
+
+
+def fingerprint_distance(a, b):
+    """Hellinger distance averaged over the light and dark halves, 0..1."""
+    n = HIST_BINS ** 3
+    total = 0.0
+    for half in (slice(0, n), slice(n, 2 * n)):
+        bc = float(np.sum(np.sqrt(a[half] * b[half])))
+        total += np.sqrt(max(0.0, 1.0 - bc))
+    return total / 2.0
+
+
+@dataclass
+class ModelEntry:
+    name: str
+    path: str
+    fingerprint: Optional[np.ndarray] = None
+    default: bool = False
+
+
+def load_ccn(path):
+    import torch
+    from ccn_model import CCN
+    from core.quantization import is_quantized_archive, load_quantized
+
+    if is_quantized_archive(path):
+        return load_quantized(path)[0]
+
+    model = CCN()
+    model.load_state_dict(torch.load(path, map_location="cpu"))
+    model.eval()
+    return model
+
+
+def model_bytes(model):
+    return sum(t.numel() * t.element_size() for t in model.state_dict().values())
+
+
+def read_manifest(manifest_path):
+    base = os.path.dirname(os.path.abspath(manifest_path))
+    with open(manifest_path, encoding="utf-8") as f:
+        data = json.load(f)
+    entries = []
+    for item in data.get("models", []):
+        fp = item.get("fingerprint")
+        entries.append(ModelEntry(
+            name=item.get("name") or os.path.splitext(os.path.basename(item["path"]))[0],
+            path=os.path.join(base, item["path"]),
+            fingerprint=np.asarray(fp, dtype=np.float32) if fp else None,
+            default=bool(item.get("default", False)),
+        ))
+    return entries
+
+
+class ModelRegistry:
+    def __init__(self, entries, max_bytes=DEFAULT_CACHE_MB << 20, loader=load_ccn, prepare=None):
+        if not entries:
+            raise ValueError("model registry is empty")
+        self.entries = entries
+        self.max_bytes = max_bytes
+        self.loader = loader
+        self.prepare = prepare         # eager model -> inference model, applied once per load
+        self.active = None
+        self._loaded = OrderedDict()   # path -> (model, bytes), least recently used first
+        self._default = next((e for e in entries if e.default), entries[0])
+
+    @classmethod
+    def from_path(cls, path, max_bytes=DEFAULT_CACHE_MB << 20, prepare=None):
+        if os.path.isdir(path):
+            manifest = os.path.join(path, MANIFEST_NAME)
+            if os.path.exists(manifest):
+                entries = read_manifest(manifest)
+            else:
+                entries = [ModelEntry(os.path.splitext(f)[0], os.path.join(path, f))
+                           for f in sorted(os.listdir(path)) if f.endswith((".pth", ".pt"))]
+        elif path.endswith(".json"):
+            entries = read_manifest(path)
+        else:
+            entries = [ModelEntry(os.path.splitext(os.path.basename(path))[0], path)]
+        return cls(entries, max_bytes, prepare=prepare)
+
+    def reset_theme(self):
+        """The capture region changed: fingerprint the next frame again."""
+        self.active = None
+
+    def select(self, image_array):
+        """Entry whose fingerprint is closest to this board's theme."""
+        if len(self.entries) == 1:
+            return self.entries[0]
+        fp = theme_fingerprint(image_array)
+        best, best_distance = self._default, MAX_DISTANCE
+        for entry in self.entries:
+            if entry.fingerprint is None or entry.fingerprint.shape != fp.shape:
+                continue
+            d = fingerprint_distance(fp, entry.fingerprint)
+            if d < best_distance:
+                best, best_distance = entry, d
+        print(f"[model] theme matches '{best.name}' (distance {best_distance:.3f})", flush=True)
+        return best
+
+    def model_for(self, image_array):
+        """Model for the current capture region, chosen on its first frame."""
+        if self.active is None:
+            self.active = self.select(image_array)
+        return self.model(self.active)
+
+    def model(self, entry):
+        cached = self._loaded.get(entry.path)
+        if cached is not None:
+            self._loaded.move_to_end(entry.path)
+            return cached[0]
+
+        model = self.loader(entry.path)
+        # Measured before prepare: frozen TorchScript has no state_dict. Int8
+        # archives arrive frozen, so their file size stands in.
+        size = model_bytes(model) or os.path.getsize(entry.path)
+        if self.prepare is not None:
+            model = self.prepare(model)
+        while self._loaded and self.loaded_bytes() + size > self.max_bytes:
+            path, _ = self._loaded.popitem(last=False)
+            print(f"[model] evicted {os.path.basename(path)}", flush=True)
+        self._loaded[entry.path] = (model, size)
+        print(f"[model] loaded '{entry.name}' ({size >> 10} KiB, "
+              f"{len(self._loaded)} in memory)", flush=True)
+        return model
+
+    def preload(self):
+        """Load and prepare the default model before the first frame arrives."""
+        return self.model(self._default)
+
+    def loaded_bytes(self):
+        return sum(size for _, size in self._loaded.values())
+
+
+def _add_entry(args):
+    from PIL import Image
+
+    image = np.array(Image.open(args.image).convert("RGB").resize((256, 256)))
+    data = {"models": []}
+    if os.path.exists(args.manifest):
+        with open(args.manifest, encoding="utf-8") as f:
+            data = json.load(f)
+    base = os.path.dirname(os.path.abspath(args.manifest))
+    rel = os.path.relpath(os.path.abspath(args.weights), base)
+    name = args.name or os.path.splitext(os.path.basename(args.weights))[0]
+    data["models"] = [m for m in data.get("models", []) if m.get("name") != name]
+    if args.default:
+        for m in data["models"]:
+            m["default"] = False
+    data["models"].append({
+        "name": name,
+        "path": rel.replace(os.sep, "/"),
+        "fingerprint": [round(float(v), 5) for v in theme_fingerprint(image)],
+        "default": args.default or not data["models"],
+    })
+    with open(args.manifest, "w", encoding="utf-8") as f:
+        json.dump(data, f, indent=2)
+    print(f"{name}: {len(data['models'])} model(s) in {args.manifest}")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Manage the recognizer model manifest")
+    sub = parser.add_subparsers(dest="command", required=True)
+    add = sub.add_parser("add", help="add or replace a model, fingerprinted from a board capture")
+    add.add_argument("manifest")
+    add.add_argument("weights")
+    add.add_argument("image")
+    add.add_argument("--name")
+    add.add_argument("--default", action="store_true")
+    _add_entry(parser.parse_args())
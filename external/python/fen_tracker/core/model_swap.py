@@ -0,0 +1,63 @@
+# core/model_swap.py
+#
+# Replaces the recognizer's models while it keeps serving frames. A
+# "[model] <path>" command builds a new registry on a background thread,
+# loads and prepares its default model, and checks it on the last frame the
+# server saw. Only then is the registry reference swapped; the frame loop
+# reads it once per frame, so every frame runs entirely on the old or the
+# new models. When several requests overlap, the newest one wins.
+
+import threading
+
+import numpy as np
+
+from core.inference import predict_board, to_tensor
+
+NUM_CLASSES = 13
+
+
+class ModelSwapper:
+    def __init__(self, registry, build, on_swapped, on_rejected):
+        """build(path) -> ModelRegistry; on_swapped(path) and
+        on_rejected(path, reason) are called from the loader thread."""
+        self.registry = registry
+        self.build = build
+        self.on_swapped = on_swapped
+        self.on_rejected = on_rejected
+        self._lock = threading.Lock()
+        self._generation = 0
+
+    def request(self, path, last_frame):
+        """Start loading path; last_frame (H x W x 3 uint8 or None) validates it."""
+        with self._lock:
+            self._generation += 1
+            generation = self._generation
+        threading.Thread(target=self._load, args=(path, last_frame, generation),
+                         name="model-swap", daemon=True).start()
+
+    def _load(self, path, last_frame, generation):
+        try:
+            registry = self.build(path)
+            registry.preload()
+            self._validate(registry, last_frame)
+        except Exception as e:
+            self.on_rejected(path, str(e))
+            return
+        with self._lock:
+            if generation != self._generation:
+                print(f"[model] {path} superseded by a newer request", flush=True)
+                return
+            self.registry = registry
+        self.on_swapped(path)
+
+    def _validate(self, registry, frame):
+        if frame is None:
+            frame = np.zeros((256, 256, 3), dtype=np.uint8)
+        board, probs = predict_board(registry.model_for(frame), to_tensor(frame))
+        if probs.shape != (8, 8, NUM_CLASSES) or not np.isfinite(probs).all():
+            raise ValueError(f"unexpected output {probs.shape} on the last frame")
+        pieces = int((board != 0).sum())
+        print(f"[model] last frame reads as {pieces} pieces with the new model", flush=True)
+        # The frame picked the theme for the new registry; pick again on the
+        # next one in case the region changes before it is swapped in.
+        registry.reset_theme()
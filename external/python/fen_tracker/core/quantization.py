@@ -0,0 +1,201 @@
+# core/quantization.py
+#
+# Post-training int8 quantization of the CCN. Calibrates activation ranges
+# on a labeled set in the utils/dataset.py layout (a directory of board
+# images plus labels.txt, one "<image> <fen>" per line), converts the model
+# to int8 convolutions, and measures it against the fp32 model on boards it
+# was not calibrated on: the rest of the set, or a separate --eval set. The
+# int8 model is only written when it loses no more accuracy than allowed;
+# the report is stored inside the file and checked again on load.
+#
+#   python -m core.quantization ccn_model_default.pth dataset/ ccn_model_int8.pt
+#       [--calibration 256] [--eval eval_dataset/]
+#       [--max-square-drop 0.05] [--max-board-drop 0.0]
+#
+# The result is a TorchScript archive and can be used wherever a .pth is
+# accepted (--model, models.json entries).
+
+import argparse
+import json
+import os
+import time
+import zipfile
+
+import numpy as np
+
+REPORT_NAME = "quantization.json"
+INPUT_SIZE = 256
+
+
+def is_quantized_archive(path):
+    """True for files written by this module (TorchScript zip with our report)."""
+    if not zipfile.is_zipfile(path):
+        return False
+    with zipfile.ZipFile(path) as z:
+        return any(n.endswith("extra/" + REPORT_NAME) for n in z.namelist())
+
+
+def load_quantized(path):
+    """Load an int8 model and its report. Refuses models that failed the gate."""
+    import torch
+
+    extra = {REPORT_NAME: ""}
+    model = torch.jit.load(path, map_location="cpu", _extra_files=extra)
+    report = json.loads(extra[REPORT_NAME] or "{}")
+    if not report.get("passed"):
+        raise ValueError(f"{os.path.basename(path)} failed its accuracy check "
+                         f"(square accuracy {report.get('int8', {}).get('square_accuracy')}, "
+                         f"fp32 {report.get('fp32', {}).get('square_accuracy')})")
+    backend = report.get("backend")
+    if backend and backend in torch.backends.quantized.supported_engines:
+        torch.backends.quantized.engine = backend
+    model.eval()
+    return model, report
+
+
+def _backend():
+    import torch
+
+    engines = torch.backends.quantized.supported_engines
+    for name in ("x86", "fbgemm", "qnnpack"):
+        if name in engines:
+            return name
+    raise RuntimeError("this torch build has no int8 CPU backend")
+
+
+def quantize(model, calibration_batches, backend):
+    """fp32 eval-mode CCN -> int8 GraphModule, activations calibrated on the batches."""
+    import torch
+    from torch.ao.quantization import get_default_qconfig_mapping
+    from torch.ao.quantization.quantize_fx import convert_fx, prepare_fx
+
+    torch.backends.quantized.engine = backend
+    example = (torch.zeros(1, 3, INPUT_SIZE, INPUT_SIZE),)
+    # prepare_fx fuses conv + bn + relu before inserting the observers.
+    prepared = prepare_fx(model.eval(), get_default_qconfig_mapping(backend), example)
+    with torch.inference_mode():
+        for images in calibration_batches:
+            prepared(images)
+    return convert_fx(prepared)
+
+
+def evaluate(model, loader):
+    """Square and whole-board accuracy plus argmax boards, in dataset order."""
+    import torch
+
+    correct_squares = correct_boards = total = 0
+    boards = []
+    start = time.perf_counter()
+    with torch.inference_mode():
+        for images, labels in loader:
+            pred = model(images).argmax(dim=-1)
+            hits = pred == labels
+            correct_squares += int(hits.sum())
+            correct_boards += int(hits.flatten(1).all(dim=1).sum())
+            total += len(images)
+            boards.append(pred)
+    elapsed = time.perf_counter() - start
+    return {
+        "square_accuracy": correct_squares / max(1, total * 64),
+        "board_accuracy": correct_boards / max(1, total),
+        "ms_per_board": 1000.0 * elapsed / max(1, total),
+    }, torch.cat(boards) if boards else None
+
+
+def run(args):
+    import torch
+    from torch.utils.data import DataLoader, Subset
+
+    from core.inference import configure_threads, default_threads
+    from core.model_registry import load_ccn
+    from utils.dataset import ChessBoardDataset
+
+    configure_threads(args.threads or default_threads())
+    dataset = ChessBoardDataset(args.dataset)
+    if len(dataset) == 0:
+        raise SystemExit(f"no samples in {os.path.join(args.dataset, 'labels.txt')}")
+    backend = _backend()
+
+    rng = np.random.default_rng(args.seed)
+    order = rng.permutation(len(dataset)).tolist()
+    calibration = Subset(dataset, order[:args.calibration])
+    # Boards seen during calibration would flatter int8 accuracy, so the gate
+    # never evaluates on them.
+    if args.eval:
+        evaluation = ChessBoardDataset(args.eval)
+        held_out = 0
+    else:
+        evaluation = Subset(dataset, order[args.calibration:])
+        held_out = len(calibration)
+    if len(evaluation) == 0:
+        raise SystemExit(f"no boards left to evaluate after {len(calibration)} for calibration; "
+                         f"lower --calibration or pass --eval")
+    fp32 = load_ccn(args.weights)
+    int8 = quantize(load_ccn(args.weights),
+                    (images for images, _ in DataLoader(calibration, batch_size=32)), backend)
+
+    # Batch of one, as the recognizer runs it, so the timings compare.
+    loader = DataLoader(evaluation, batch_size=1)
+    fp32_metrics, fp32_boards = evaluate(fp32, loader)
+    int8_metrics, int8_boards = evaluate(int8, loader)
+    square_drop = 100.0 * (fp32_metrics["square_accuracy"] - int8_metrics["square_accuracy"])
+    board_drop = 100.0 * (fp32_metrics["board_accuracy"] - int8_metrics["board_accuracy"])
+    report = {
+        "source": os.path.basename(args.weights),
+        "dataset": os.path.abspath(args.dataset),
+        "eval_dataset": os.path.abspath(args.eval) if args.eval else None,
+        "samples": len(dataset),
+        "calibration_samples": len(calibration),
+        "evaluation_samples": len(evaluation),
+        "held_out_from_evaluation": held_out,
+        "backend": backend,
+        "torch": torch.__version__,
+        "fp32": fp32_metrics,
+        "int8": int8_metrics,
+        "agreement": float((fp32_boards == int8_boards).float().mean()),
+        "square_drop_pct": square_drop,
+        "board_drop_pct": board_drop,
+        "passed": square_drop <= args.max_square_drop and board_drop <= args.max_board_drop,
+    }
+
+    source = args.eval if args.eval else "the rest"
+    print(f"{len(dataset)} boards, {len(calibration)} for calibration, "
+          f"{len(evaluation)} evaluated ({source}), backend {backend}")
+    for name in ("fp32", "int8"):
+        m = report[name]
+        print(f"  {name}  squares {100 * m['square_accuracy']:.3f}%  "
+              f"boards {100 * m['board_accuracy']:.2f}%  {m['ms_per_board']:.2f} ms/board")
+    print(f"  int8 vs fp32: {report['agreement'] * 100:.3f}% of squares agree, "
+          f"{fp32_metrics['ms_per_board'] / max(1e-9, int8_metrics['ms_per_board']):.2f}x faster")
+
+    if not report["passed"]:
+        print(f"FAILED: accuracy drop {square_drop:.3f} pp squares / {board_drop:.2f} pp boards "
+              f"exceeds {args.max_square_drop} / {args.max_board_drop}; {args.output} not written")
+        return 1
+
+    example = torch.zeros(1, 3, INPUT_SIZE, INPUT_SIZE)
+    with torch.inference_mode():
+        scripted = torch.jit.freeze(torch.jit.trace(int8, example).eval())
+    torch.jit.save(scripted, args.output, _extra_files={REPORT_NAME: json.dumps(report, indent=2)})
+    print(f"wrote {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Calibrate and write an int8 recognizer model")
+    parser.add_argument("weights", help="fp32 CCN weights (.pth)")
+    parser.add_argument("dataset", help="directory with board images and labels.txt")
+    parser.add_argument("output", help="int8 model to write (.pt)")
+    parser.add_argument("--calibration", type=int, default=256,
+                        help="boards used to calibrate activation ranges; "
+                             "held out of the evaluation unless --eval is given")
+    parser.add_argument("--eval", default="",
+                        help="separate labeled set to evaluate on (default: the boards "
+                             "of the dataset not used for calibration)")
+    parser.add_argument("--max-square-drop", type=float, default=0.05,
+                        help="allowed loss of per-square accuracy, percentage points")
+    parser.add_argument("--max-board-drop", type=float, default=0.0,
+                        help="allowed loss of whole-board accuracy, percentage points")
+    parser.add_argument("--threads", type=int, default=0)
+    parser.add_argument("--seed", type=int, default=0)
+    raise SystemExit(run(parser.parse_args()))
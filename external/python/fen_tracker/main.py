@@ -1,33 +1,52 @@
 # main.py
+import time
+STARTED_NS = time.perf_counter_ns()   # before the heavy imports, for the startup report
+
 import argparse
 import os
-import torch
-import torch.nn.functional as F
-from torchvision import transforms
+import sys
 from PIL import Image
-from ccn_model import CCN
+from core.inference import configure_threads, default_threads, optimize, predict_board, to_tensor
+from core.model_registry import ModelRegistry, DEFAULT_CACHE_MB, MANIFEST_NAME
+from core.model_swap import ModelSwapper
 from core.game_state_tracker import GameStateTracker
-from core.turn_detector import detect_turn_from_images
+from core.turn_detector import detect_turn, mask_bits
 from utils.board_utils import flip_fen_pov, PIECE_TO_IDX
+from utils.protocol import ResultChannel, SKIP_NOT_STABLE, SKIP_UNCHANGED
 from skimage.metrics import structural_similarity as ssim
 import numpy as np
 from collections import deque
 
 
+# stdout carries the binary result channel; everything printed goes to stderr.
+results = ResultChannel(sys.stdout.buffer)
+sys.stdout = sys.stderr
+
 parser = argparse.ArgumentParser()
 parser.add_argument("--color", choices=["w", "b"], default="w")
+parser.add_argument("--model", default=None,
+                    help="weight file, models.json manifest or directory with one "
+                         "(default: models.json next to this script, else ccn_model_default.pth)")
+parser.add_argument("--model-cache-mb", type=int, default=DEFAULT_CACHE_MB,
+                    help="memory bound for loaded models")
+parser.add_argument("--threads", type=int, default=default_threads(),
+                    help="torch intra-op threads (default: a quarter of the cores)")
 args = parser.parse_args()
 my_color = args.color
 print(f"[startup] my_color = {my_color}", flush=True)
 
 
 
-def predict_board(model, image_tensor):
-    model.eval()
-    with torch.no_grad():
-        out = model(image_tensor.unsqueeze(0))  # [1, 8, 8, 13]
-        pred = F.softmax(out, dim=-1).argmax(dim=-1)  # [1, 8, 8]
-    return pred.squeeze(0).cpu().numpy()
+def parse_request(line):
+    """'[frame] <seq> <path>' -> (seq, path); a bare path gets sequence 0."""
+    if line.startswith("[frame]"):
+        _, seq, path = line.split(maxsplit=2)
+        return int(seq), path
+    return 0, line
+
+
+def elapsed_us(start_ns):
+    return (time.perf_counter_ns() - start_ns) // 1000
 
 last_image_array = None
 last_ssim = 0.0
@@ -49,44 +68,67 @@ INITIAL_BOARD = np.array([
 ], dtype=np.uint8)
 
 def main():
-    import sys
-    from collections import deque
-
     global last_image_array, last_emitted_fen, last_ssim, current_ssim, prev_board_matrix
 
-    model = CCN()
-
     script_dir = os.path.dirname(os.path.abspath(__file__))
-    model_path = os.path.join(script_dir, "ccn_model_default.pth")
-
-    model.load_state_dict(torch.load(model_path, map_location="cpu"))
-
-    model.eval()
-
-    transform = transforms.Compose([
-        transforms.Resize((256, 256)),
-        transforms.ToTensor()
-    ])
+    model_path = args.model
+    if not model_path:
+        manifest = os.path.join(script_dir, MANIFEST_NAME)
+        model_path = manifest if os.path.exists(manifest) else os.path.join(script_dir, "ccn_model_default.pth")
+    configure_threads(args.threads)
+    def build_registry(path):
+        return ModelRegistry.from_path(path, args.model_cache_mb << 20, prepare=optimize)
+
+    def swapped(path):
+        print(f"[model] now serving {path}", flush=True)
+        results.model_swapped(path)
+
+    def rejected(path, reason):
+        print(f"[model] keeping the current model, {path} rejected: {reason}", flush=True)
+        results.model_rejected(path, reason)
+
+    print(f"[startup] imports took {elapsed_us(STARTED_NS) // 1000} ms", flush=True)
+    registry = build_registry(model_path)
+    print(f"[startup] {len(registry.entries)} model(s) from {model_path}, "
+          f"{args.threads} inference thread(s)", flush=True)
+    registry.preload()
+    models = ModelSwapper(registry, build_registry, swapped, rejected)
 
     tracker = GameStateTracker()
     global prev_board_matrix
     prev_board_matrix = INITIAL_BOARD.copy()
-    print("ready")
-    sys.stdout.flush()
+    startup_us = elapsed_us(STARTED_NS)
+    print(f"[startup] ready after {startup_us // 1000} ms", flush=True)
+    results.ready(startup_us)
 
     for line in sys.stdin:
+        received_ns = time.perf_counter_ns()
         line = line.strip()
+        if not line:
+            continue
         if line.startswith("[color]"):
             new_color = line.split("]")[-1].strip()
             if new_color in ("w", "b"):
                 my_color = new_color
                 print(f"[update] my_color updated to: {my_color}", flush=True)
             continue
+        if line.startswith("[region]"):
+            # New capture region, possibly another site or theme.
+            models.registry.reset_theme()
+            continue
+        if line.startswith("[model]"):
+            new_path = line[len("[model]"):].strip()
+            if new_path:
+                print(f"[model] loading {new_path} in the background", flush=True)
+                models.request(os.path.abspath(new_path), last_image_array)
+            continue
 
-        path = os.path.abspath(line)
-        print(f"[python received] {path}", flush=True)
-
+        seq = 0
         try:
+            seq, path = parse_request(line)
+            path = os.path.abspath(path)
+            print(f"[python received] #{seq} {path}", flush=True)
+
             image = Image.open(path).convert("RGB")
             image_array = np.array(image)
 
@@ -99,12 +141,17 @@ def main():
                 current_ssim = 1.0
                 print("[debug] First frame — initializing SSIM", flush=True)
 
-                tensor = transform(image)
-                board = predict_board(model, tensor)
+                model = models.registry.model_for(image_array)
+                tensor = to_tensor(image_array)
+                infer_start = time.perf_counter_ns()
+                board, probs = predict_board(model, tensor)
+                infer_us = elapsed_us(infer_start)
                 fen = tracker.update(board)
                 if my_color == 'b':
                     fen = flip_fen_pov(fen)
                 print(f"[FEN] {fen}", flush=True)
+                results.result(seq, board, fen, my_color == 'b',
+                               elapsed_us(received_ns), infer_us, probs)
                 last_emitted_fen = fen
                 prev_board_matrix = board.copy()
                 continue
@@ -115,18 +162,20 @@ def main():
             last_ssim, current_ssim = current_ssim, similarity
 
             if last_ssim < SSIM_THRESHOLD and current_ssim >= SSIM_THRESHOLD:
-                tensor = transform(image)
-                board = predict_board(model, tensor)
+                model = models.registry.model_for(image_array)
+                tensor = to_tensor(image_array)
+                infer_start = time.perf_counter_ns()
+                board, probs = predict_board(model, tensor)
+                infer_us = elapsed_us(infer_start)
 
-                # Detect turn using image difference
+                # Detect turn and changed squares from the image difference
                 mover_color = None
+                changed = None
                 if last_image_array is not None and prev_board_matrix is not None:
                     try:
-                        mover_color = detect_turn_from_images(
-                            Image.fromarray(last_image_array),
-                            image,
-                            prev_board_matrix
-                        )
+                        mover_color, mask = detect_turn(last_image_array, image_array,
+                                                        prev_board_matrix)
+                        changed = mask_bits(mask)
                     except Exception as e:
                         print(f"[warn] Turn detection failed: {e}", flush=True)
 
@@ -145,23 +194,26 @@ def main():
 
                 if fen != last_emitted_fen:
                     print(f"[FEN] {fen}", flush=True)
+                    results.result(seq, board, fen, my_color == 'b',
+                                   elapsed_us(received_ns), infer_us, probs, changed)
                     last_emitted_fen = fen
                 else:
                     print("[skip] FEN unchanged — skipping output", flush=True)
+                    results.skip(seq, SKIP_UNCHANGED, elapsed_us(received_ns))
 
                 # Update previous board state for next round
                 prev_board_matrix = board.copy()
 
             else:
                 print("[skip] Board not stable yet", flush=True)
+                results.skip(seq, SKIP_NOT_STABLE, elapsed_us(received_ns))
 
             # store the current frame for next comparison
             last_image_array = np.copy(image_array)
 
         except Exception as e:
             print(f"[error] {e}", flush=True)
-
-        sys.stdout.flush()
+            results.error(seq, str(e))
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,99 @@
+# mock_server.py
+#
+# Stand-in for main.py that skips vision entirely. Every frame request is
+# answered with the position currently written in the --state file (one FEN
+# per file, rewritten by the latency benchmark whenever it changes the board).
+# Comparing a run against the real server separates recognition cost from
+# capture/IPC/engine/paint overhead.
+
+import argparse
+import sys
+import time
+
+import numpy as np
+
+from utils.board_utils import PIECE_TO_IDX
+from utils.protocol import ResultChannel, SKIP_UNCHANGED
+
+results = ResultChannel(sys.stdout.buffer)
+sys.stdout = sys.stderr
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--color", choices=["w", "b"], default="w")
+parser.add_argument("--state", required=True, help="file holding the current FEN")
+parser.add_argument("--delay-ms", type=float, default=0.0,
+                    help="simulated inference time per frame")
+args = parser.parse_args()
+
+
+def fen_to_grid(fen, flipped):
+    """FEN placement -> 8x8 class grid in capture orientation."""
+    grid = np.zeros((8, 8), dtype=np.uint8)
+    for row, rank in enumerate(fen.split()[0].split('/')[:8]):
+        col = 0
+        for ch in rank:
+            if ch.isdigit():
+                col += int(ch)
+            elif col < 8:
+                grid[row, col] = PIECE_TO_IDX.get(ch, 0)
+                col += 1
+    return np.rot90(grid, 2).copy() if flipped else grid
+
+
+def read_state():
+    try:
+        with open(args.state, encoding="utf-8") as f:
+            return f.read().strip()
+    except OSError:
+        return ""
+
+
+def parse_request(line):
+    if line.startswith("[frame]"):
+        _, seq, path = line.split(maxsplit=2)
+        return int(seq), path
+    return 0, line
+
+
+def main():
+    my_color = args.color
+    last_fen = None
+    results.ready()
+
+    for line in sys.stdin:
+        received_ns = time.perf_counter_ns()
+        line = line.strip()
+        if not line:
+            continue
+        if line.startswith("[color]"):
+            new_color = line.split("]")[-1].strip()
+            if new_color in ("w", "b"):
+                my_color = new_color
+                last_fen = None
+            continue
+        if line.startswith("["):
+            if not line.startswith("[frame]"):
+                continue
+
+        seq = 0
+        try:
+            seq, _ = parse_request(line)
+            fen = read_state()
+            if not fen or fen == last_fen:
+                results.skip(seq, SKIP_UNCHANGED)
+                continue
+
+            if args.delay_ms > 0:
+                time.sleep(args.delay_ms / 1000.0)
+            flipped = my_color == 'b'
+            grid = fen_to_grid(fen, flipped)
+            server_us = (time.perf_counter_ns() - received_ns) // 1000
+            results.result(seq, grid, fen, flipped, server_us, server_us)
+            last_fen = fen
+        except Exception as e:
+            print(f"[error] {e}", flush=True)
+            results.error(seq, str(e))
+
+
+if __name__ == "__main__":
+    main()
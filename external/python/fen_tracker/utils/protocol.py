@@ -0,0 +1,117 @@
+# utils/protocol.py
+#
+# Binary result channel to the GUI. Keep in sync with recognizerprotocol.h.
+#
+#   b"FENR" | uint32 payload length | payload
+#
+# payload (little-endian):
+#   uint8 version, uint8 type, uint16 flags,
+#   uint32 frame sequence, uint32 server micros (startup for MSG_READY),
+#   uint32 inference micros,
+#   uint8 grid[64] (image orientation), char side, uint8 castling,
+#   uint8 en passant square (a1 = 0, 64 = none), uint8 skip reason,
+#   [uint64 changed squares]        if FLAG_CHANGED, bit row * 8 + col
+#   [uint8 probabilities[64 * 13]]  if FLAG_PROBS
+#   [utf-8 text]                    for MSG_ERROR (error), MSG_MODEL_SWAPPED
+#                                   (model path), MSG_MODEL_REJECTED (reason)
+
+import struct
+import threading
+
+import numpy as np
+
+MAGIC = b"FENR"
+# 2: optional changed-squares mask before the probabilities, model swap
+# answers. Readers skip messages of any other version.
+VERSION = 2
+
+MSG_READY = 0
+MSG_RESULT = 1
+MSG_SKIP = 2
+MSG_ERROR = 3
+MSG_MODEL_SWAPPED = 4
+MSG_MODEL_REJECTED = 5
+
+FLAG_PROBS = 1
+FLAG_FLIPPED = 2
+FLAG_CHANGED = 4
+
+SKIP_NONE = 0
+SKIP_NOT_STABLE = 1
+SKIP_UNCHANGED = 2
+
+NO_SQUARE = 64
+
+_FIXED = struct.Struct("<BBHIII")
+_STATE = struct.Struct("<cBBB")
+_MASK = struct.Struct("<Q")
+_EMPTY_GRID = bytes(64)
+_CASTLING_BITS = {"K": 1, "Q": 2, "k": 4, "q": 8}
+
+
+def fen_state(fen):
+    """Extract (side, castling bits, en passant square) from a FEN string."""
+    parts = fen.split()
+    side = parts[1] if len(parts) > 1 else "w"
+    castling = 0
+    if len(parts) > 2:
+        for ch in parts[2]:
+            castling |= _CASTLING_BITS.get(ch, 0)
+    ep = NO_SQUARE
+    if len(parts) > 3 and len(parts[3]) == 2:
+        ep = (int(parts[3][1]) - 1) * 8 + (ord(parts[3][0]) - ord("a"))
+    return side, castling, ep
+
+
+def quantize_probs(probs):
+    return np.clip(np.rint(probs * 255.0), 0, 255).astype(np.uint8).tobytes()
+
+
+class ResultChannel:
+    def __init__(self, stream):
+        self.stream = stream
+        self._lock = threading.Lock()   # the model loader thread reports too
+
+    def _send(self, msg_type, seq, flags=0, server_us=0, infer_us=0, grid=None,
+              side="w", castling=0, ep=NO_SQUARE, skip_reason=SKIP_NONE,
+              changed=None, probs=None, text=None):
+        if changed is not None:
+            flags |= FLAG_CHANGED
+        if probs is not None:
+            flags |= FLAG_PROBS
+        grid_bytes = _EMPTY_GRID if grid is None else np.asarray(grid, dtype=np.uint8).tobytes()
+        payload = b"".join((
+            _FIXED.pack(VERSION, msg_type, flags, seq & 0xFFFFFFFF,
+                        min(server_us, 0xFFFFFFFF), min(infer_us, 0xFFFFFFFF)),
+            grid_bytes,
+            _STATE.pack(side.encode("ascii"), castling, ep, skip_reason),
+            _MASK.pack(changed) if changed is not None else b"",
+            quantize_probs(probs) if probs is not None else b"",
+            text.encode("utf-8") if text else b"",
+        ))
+        with self._lock:
+            self.stream.write(MAGIC + struct.pack("<I", len(payload)) + payload)
+            self.stream.flush()
+
+    def ready(self, startup_us=0):
+        """startup_us travels in the server micros field."""
+        self._send(MSG_READY, 0, server_us=startup_us)
+
+    def result(self, seq, board, fen, flipped, server_us, infer_us, probs=None, changed=None):
+        """changed: optional int, bit row * 8 + col set per square that differs
+        from the previous frame (image orientation)."""
+        side, castling, ep = fen_state(fen)
+        self._send(MSG_RESULT, seq, FLAG_FLIPPED if flipped else 0, server_us, infer_us,
+                   board, side, castling, ep, changed=changed, probs=probs)
+
+    def skip(self, seq, reason, server_us=0):
+        self._send(MSG_SKIP, seq, server_us=server_us, skip_reason=reason)
+
+    def error(self, seq, text):
+        self._send(MSG_ERROR, seq, text=text)
+
+    def model_swapped(self, path):
+        self._send(MSG_MODEL_SWAPPED, 0, text=path)
+
+    def model_rejected(self, path, reason):
+        self._send(MSG_MODEL_REJECTED, 0, text=f"{path}: {reason}")
@@ -0,0 +1,215 @@
+#include "gametracker.h"
+
+#include <cstring>
+
+namespace {
+
+struct ZobristKeys {
+    uint64_t piece[13][64];  // piece[0] (empty) stays zero
+    uint64_t castling[16];
+    uint64_t epFile[8];
+    uint64_t blackToMove;
+
+    ZobristKeys() {
+        // splitmix64: fixed seed, so keys are stable across runs.
+        uint64_t state = 0x4368657373475549ULL;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        std::memset(piece[0], 0, sizeof(piece[0]));
+        for (int p = 1; p < 13; ++p) {
+            for (int sq = 0; sq < 64; ++sq)
+                piece[p][sq] = next();
+        }
+        for (uint64_t &k : castling)
+            k = next();
+        for (uint64_t &k : epFile)
+            k = next();
+        blackToMove = next();
+    }
+};
+
+const ZobristKeys &zobrist() {
+    static const ZobristKeys keys;
+    return keys;
+}
+
+// True if side c has a pawn that could capture on epSquare. Only then does
+// the en passant square distinguish positions (FIDE 9.2), so only then is
+// it hashed.
+bool canCaptureEnPassant(const ChessPosition &p, ChessPosition::Color c, int epSquare) {
+    if (epSquare == ChessPosition::NoSquare)
+        return false;
+    const uint8_t pawn = ChessPosition::makePiece(c, ChessPosition::Pawn);
+    const int from = c == ChessPosition::White ? epSquare - 8 : epSquare + 8;
+    const int file = epSquare % 8;
+    return (file > 0 && p.pieceAt(from - 1) == pawn)
+        || (file < 7 && p.pieceAt(from + 1) == pawn);
+}
+
+uint64_t epKey(const ChessPosition &p) {
+    int ep = p.enPassantSquare();
+    return canCaptureEnPassant(p, p.sideToMove(), ep) ? zobrist().epFile[ep % 8] : 0;
+}
+
+// Castling rights the placement still allows: king and rook on their
+// original squares.
+uint8_t placementRights(const uint8_t *sq) {
+    uint8_t rights = 0;
+    if (sq[4] == ChessPosition::WKing) {
+        if (sq[7] == ChessPosition::WRook)
+            rights |= ChessPosition::WhiteKingSide;
+        if (sq[0] == ChessPosition::WRook)
+            rights |= ChessPosition::WhiteQueenSide;
+    }
+    if (sq[60] == ChessPosition::BKing) {
+        if (sq[63] == ChessPosition::BRook)
+            rights |= ChessPosition::BlackKingSide;
+        if (sq[56] == ChessPosition::BRook)
+            rights |= ChessPosition::BlackQueenSide;
+    }
+    return rights;
+}
+
+} // namespace
+
+GameTracker::GameTracker() {
+    moveList.reserve(256);
+    counts.reserve(512);
+}
+
+void GameTracker::reset() {
+    pos = ChessPosition();
+    started = false;
+    lastChange = Unchanged;
+    currentKey = 0;
+    moveList.clear();
+    lastSan.clear();
+    counts.clear();
+}
+
+uint64_t GameTracker::computeKey(const ChessPosition &p) {
+    const ZobristKeys &z = zobrist();
+    uint64_t k = 0;
+    for (int sq = 0; sq < 64; ++sq)
+        k ^= z.piece[p.pieceAt(sq)][sq];
+    k ^= z.castling[p.castlingRights() & 15];
+    k ^= epKey(p);
+    if (p.sideToMove() == ChessPosition::Black)
+        k ^= z.blackToMove;
+    return k;
+}
+
+uint64_t GameTracker::keyAfter(const ChessMove &m) const {
+    const ZobristKeys &z = zobrist();
+    const ChessPosition::Color us = pos.sideToMove();
+    const ChessPosition::Color them = us == ChessPosition::White ? ChessPosition::Black
+                                                                 : ChessPosition::White;
+    const uint8_t moving = pos.pieceAt(m.from);
+    uint64_t k = currentKey;
+
+    k ^= z.piece[moving][m.from];
+    if (m.flags & ChessMove::EnPassant) {
+        int capSq = us == ChessPosition::White ? m.to - 8 : m.to + 8;
+        k ^= z.piece[pos.pieceAt(capSq)][capSq];
+    } else {
+        k ^= z.piece[pos.pieceAt(m.to)][m.to];
+    }
+    uint8_t placed = m.promotion
+        ? ChessPosition::makePiece(us, ChessPosition::PieceType(m.promotion)) : moving;
+    k ^= z.piece[placed][m.to];
+
+    if (m.flags & ChessMove::Castle) {
+        int rookFrom = -1, rookTo = -1;
+        switch (m.to) {
+        case 6:  rookFrom = 7;  rookTo = 5;  break;
+        case 2:  rookFrom = 0;  rookTo = 3;  break;
+        case 62: rookFrom = 63; rookTo = 61; break;
+        case 58: rookFrom = 56; rookTo = 59; break;
+        default: break;
+        }
+        if (rookFrom >= 0) {
+            uint8_t rook = pos.pieceAt(rookFrom);
+            k ^= z.piece[rook][rookFrom] ^ z.piece[rook][rookTo];
+        }
+    }
+
+    const uint8_t rights = pos.castlingRights();
+    k ^= z.castling[rights & 15] ^ z.castling[ChessPosition::castlingAfter(rights, m) & 15];
+
+    k ^= epKey(pos);
+    if (m.flags & ChessMove::DoublePush) {
+        // The squares beside the pawn's destination are untouched by the
+        // push, so the current board answers for the position after it.
+        int ep = (m.from + m.to) / 2;
+        if (canCaptureEnPassant(pos, them, ep))
+            k ^= z.epFile[ep % 8];
+    }
+
+    return k ^ z.blackToMove;
+}
+
+int GameTracker::occurrences(uint64_t k) const {
+    auto it = counts.find(k);
+    return it == counts.end() ? 0 : it->second;
+}
+
+GameTracker::Change GameTracker::update(const ChessPosition &observed) {
+    if (!started) {
+        resync(observed);
+        return lastChange;
+    }
+    if (std::memcmp(pos.squares(), observed.squares(), 64) == 0) {
+        lastChange = Unchanged;
+        return lastChange;
+    }
+
+    ChessMove m = pos.findMoveTo(observed.squares());
+    if (m.isNull()) {
+        // The side to move may have been guessed wrong when the tracker
+        // (re)started; if the other side's move fits, that was the case.
+        const ChessPosition::Color side = pos.sideToMove();
+        pos.setSideToMove(side == ChessPosition::White ? ChessPosition::Black
+                                                       : ChessPosition::White);
+        m = pos.findMoveTo(observed.squares());
+        if (m.isNull()) {
+            pos.setSideToMove(side);
+            resync(observed);
+            return lastChange;
+        }
+        if (--counts[currentKey] <= 0)
+            counts.erase(currentKey);
+        currentKey = computeKey(pos);
+        ++counts[currentKey];
+    }
+
+    currentKey = keyAfter(m);
+    lastSan = pos.moveToSan(m);
+    pos.makeMove(m);
+    moveList.push_back(m);
+    ++counts[currentKey];
+    lastChange = Moved;
+    return lastChange;
+}
+
+void GameTracker::resync(const ChessPosition &observed) {
+    uint8_t rights = observed.castlingRights() & placementRights(observed.squares());
+    if (started)
+        rights &= pos.castlingRights();  // lost rights never come back
+    int fullmove = started ? pos.fullmoveNumber() : observed.fullmoveNumber();
+
+    PackedPosition next = observed.packed();
+    next.castling = rights;
+    next.epSquare = ChessPosition::NoSquare;
+    next.halfmove = 0;
+    next.fullmove = uint16_t(fullmove);
+    pos.setFromPacked(next);
+
+    currentKey = computeKey(pos);
+    ++counts[currentKey];
+    started = true;
+    lastChange = Resynced;
+}
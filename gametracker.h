@@ -0,0 +1,66 @@
+#ifndef GAMETRACKER_H
+#define GAMETRACKER_H
+
+#include "chessposition.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The game as seen on the board. Each recognized position is joined to the
+// previous one by the legal move between them, so castling rights, the en
+// passant square and the halfmove clock follow the actual moves instead of
+// the recognizer's guesses. Every position is identified by a Zobrist key
+// updated incrementally per move. Repetition counts sit in a hash map, so
+// threefold and fifty-move checks are O(1).
+//
+// When no single move explains an observation (a missed move, a misread
+// frame that got through), the tracker resynchronises on it. The move list
+// then has a gap, but earlier positions still count for repetitions.
+class GameTracker
+{
+public:
+    enum Change { Unchanged, Moved, Resynced };
+
+    GameTracker();
+
+    void reset();
+    bool isEmpty() const { return !started; }
+
+    // observed: the recognized position; only placement, side to move and
+    // castling rights are used (rights are narrowed to what the game allows).
+    Change update(const ChessPosition &observed);
+
+    const ChessPosition &position() const { return pos; }
+    std::string fen() const { return pos.fen(); }
+    uint64_t key() const { return currentKey; }
+    const std::vector<ChessMove> &moves() const { return moveList; }
+    ChessMove lastMove() const { return lastChange == Moved ? moveList.back() : ChessMove(); }
+    // SAN of lastMove(), written before the move was played.
+    std::string lastMoveSan() const { return lastChange == Moved ? lastSan : std::string(); }
+
+    // Occurrences of the current position, this one included.
+    int repetitions() const { return occurrences(currentKey); }
+    // Earlier occurrences of the position m (legal here) leads to.
+    int repetitionsAfter(const ChessMove &m) const { return occurrences(keyAfter(m)); }
+    bool isThreefoldRepetition() const { return repetitions() >= 3; }
+    bool isFiftyMoveDraw() const { return pos.halfmoveClock() >= 100; }
+
+    // From scratch; the incremental keys always equal this.
+    static uint64_t computeKey(const ChessPosition &position);
+
+private:
+    ChessPosition pos;
+    bool started = false;
+    Change lastChange = Unchanged;
+    uint64_t currentKey = 0;
+    std::vector<ChessMove> moveList;
+    std::string lastSan;
+    std::unordered_map<uint64_t, int> counts;
+
+    uint64_t keyAfter(const ChessMove &m) const;
+    int occurrences(uint64_t k) const;
+    void resync(const ChessPosition &observed);
+};
+
+#endif // GAMETRACKER_H
@@ -0,0 +1,193 @@
+#include "latencybenchmark.h"
+#include "mainwindow.h"
+#include "./ui_mainwindow.h"
+#include "boardwidget.h"
+#include "chessposition.h"
+#include "latencystats.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+
+LatencyBenchmark::LatencyBenchmark(MainWindow *mainWindow, const Options &opts, QObject *parent)
+    : QObject(parent), window(mainWindow), options(opts)
+{
+    if (options.moves.isEmpty())
+        options.moves = defaultMoves();
+
+    timeoutTimer = new QTimer(this);
+    timeoutTimer->setSingleShot(true);
+    connect(timeoutTimer, &QTimer::timeout, this, &LatencyBenchmark::handleTimeout);
+
+    stateFile = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+                    .filePath("chessgui_bench_state.fen");
+}
+
+LatencyBenchmark::~LatencyBenchmark()
+{
+    delete site;
+    QFile::remove(stateFile);
+}
+
+QStringList LatencyBenchmark::defaultMoves()
+{
+    // Ruy Lopez, Closed: no promotions, so every one of our moves is a plain
+    // from-to arrow.
+    return QString("e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7 "
+                   "f1e1 b7b5 a4b3 d7d6 c2c3 e8g8 h2h3 c6a5 b3c2 c7c5 "
+                   "d2d4 d8c7 b1d2 c5d4 c3d4 a5c6 d2b3 a6a5 c1e3 a5a4")
+        .split(' ', Qt::SkipEmptyParts);
+}
+
+void LatencyBenchmark::start()
+{
+    ChessPosition position;
+    position.setFromFen(ChessPosition::startFen());
+    positions << position.packed();
+    for (const QString &uci : options.moves) {
+        ChessMove move = position.parseUciMove(uci.toStdString());
+        if (move.isNull()) {
+            qWarning() << "[bench] Illegal move in script:" << uci << "- stopping script there";
+            break;
+        }
+        position.makeMove(move);
+        positions << position.packed();
+    }
+
+    // The stand-in site sits beside the main window so neither covers the other.
+    site = new BoardWidget();
+    site->setWindowTitle("Latency benchmark board");
+    site->setGeometry(window->frameGeometry().right() + 40, 40, 480, 480);
+    site->show();
+
+    window->ui->automoveCheck->setChecked(false);
+    window->ui->stealthCheck->setChecked(false);
+
+    if (options.mockEngine) {
+        window->engineKind = EngineBackend::Mock;
+        window->startEngine();
+    }
+    if (options.mockRecognizer) {
+        writeState(QString());
+        window->recognizerScript =
+            QCoreApplication::applicationDirPath() + "/python/fen_tracker/mock_server.py";
+        window->recognizerArguments = QStringList() << "--state" << stateFile;
+        window->startFenServer();
+    }
+
+    connect(window->board->overlay(), &ArrowOverlay::painted,
+            this, &LatencyBenchmark::handleOverlayPainted);
+
+    qInfo().noquote() << QString("[bench] %1 positions, recognizer: %2, engine: %3")
+                             .arg(positions.size())
+                             .arg(options.mockRecognizer ? "mock" : "model")
+                             .arg(EngineBackend::kindName(EngineBackend::Kind(window->engineKind)));
+
+    QTimer::singleShot(options.warmupMs, this, [this]() {
+        window->setCaptureRegion(QRect(site->mapToGlobal(QPoint(0, 0)), site->size()));
+        if (!window->analysisRunning)
+            window->on_toggleAnalysisButton_clicked();
+        clock.start();
+        step();
+    });
+}
+
+void LatencyBenchmark::step()
+{
+    if (++index >= positions.size()) {
+        report();
+        return;
+    }
+
+    expectedPosition = positions.at(index);
+    const QString fen = QString::fromStdString(expectedPosition.fen());
+    bool flipped = window->getMyColor() == "b";
+    expectArrows = (expectedPosition.side == ChessPosition::Black) == flipped;
+
+    // Paint synchronously so the timestamp is taken with the new position
+    // already on the glass.
+    site->setPosition(expectedPosition, flipped);
+    site->repaint();
+    if (options.mockRecognizer)
+        writeState(fen);
+
+    samples.append({fen, -1.0});
+    shownAt = clock.nsecsElapsed();
+    waiting = true;
+    timeoutTimer->start(options.timeoutMs);
+}
+
+void LatencyBenchmark::handleOverlayPainted(int arrowCount)
+{
+    if (!waiting)
+        return;
+    if (!window->livePosition.samePlacement(expectedPosition))
+        return;
+    if (expectArrows != (arrowCount > 0))
+        return;
+
+    samples.last().latencyMs = (clock.nsecsElapsed() - shownAt) / 1e6;
+    waiting = false;
+    timeoutTimer->stop();
+    QTimer::singleShot(options.settleMs, this, &LatencyBenchmark::step);
+}
+
+void LatencyBenchmark::handleTimeout()
+{
+    if (!waiting)
+        return;
+    qWarning() << "[bench] Timed out on" << samples.last().fen;
+    waiting = false;
+    step();
+}
+
+void LatencyBenchmark::writeState(const QString &fen)
+{
+    // Atomic replace: the mock recognizer must never read a half-written FEN.
+    QSaveFile file(stateFile);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        file.write(fen.toUtf8());
+        file.commit();
+    }
+}
+
+void LatencyBenchmark::report()
+{
+    if (window->analysisRunning)
+        window->on_toggleAnalysisButton_clicked();
+
+    QVector<double> latencies;
+    for (const Sample &s : samples) {
+        if (s.latencyMs >= 0.0)
+            latencies.append(s.latencyMs);
+    }
+    QTextStream out(stdout);
+    out << "glass-to-arrow latency: " << latencies.size() << " of " << samples.size()
+        << " positions (" << samples.size() - latencies.size() << " timed out), recognizer: "
+        << (options.mockRecognizer ? "mock" : "model") << "\n";
+    if (!latencies.isEmpty())
+        out << "  " << LatencyStats::of(latencies).summary() << "\n";
+    out.flush();
+
+    if (!options.outputPath.isEmpty()) {
+        QFile csv(options.outputPath);
+        if (csv.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream stream(&csv);
+            stream << "index,fen,latency_ms\n";
+            for (int i = 0; i < samples.size(); ++i) {
+                stream << i << ",\"" << samples.at(i).fen << "\",";
+                if (samples.at(i).latencyMs >= 0.0)
+                    stream << QString::number(samples.at(i).latencyMs, 'f', 3);
+                stream << "\n";
+            }
+        } else {
+            qWarning() << "[bench] Cannot write" << options.outputPath;
+        }
+    }
+
+    emit finished(latencies.isEmpty() ? 1 : 0);
+}
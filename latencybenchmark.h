@@ -0,0 +1,73 @@
+#ifndef LATENCYBENCHMARK_H
+#define LATENCYBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include "packedposition.h"
+
+class MainWindow;
+class BoardWidget;
+class QTimer;
+
+// End-to-end "glass-to-arrow" benchmark. Shows a stand-in chess site (a
+// BoardWidget in its own top-level window), points the main window's capture
+// region at it and plays a scripted game on it. Each position is timestamped
+// when it is painted and again when the main window's ArrowOverlay paints the
+// matching result: the engine arrow on our turn, the cleared board on the
+// opponent's. Runs under any platform plugin that can grab windows, including
+// offscreen and Xvfb.
+class LatencyBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QStringList moves;            // UCI moves from the start position
+        bool mockRecognizer = false;  // answer frames from a state file, no vision
+        bool mockEngine = false;      // use the MockUciEngine backend
+        int warmupMs = 3000;          // recognizer/engine start-up allowance
+        int settleMs = 300;           // pause between a result and the next move
+        int timeoutMs = 15000;        // give up on a position after this long
+        QString outputPath;           // optional per-position CSV
+    };
+
+    LatencyBenchmark(MainWindow *window, const Options &options, QObject *parent = nullptr);
+    ~LatencyBenchmark() override;
+
+    void start();
+
+    static QStringList defaultMoves();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    struct Sample {
+        QString fen;
+        double latencyMs = -1.0;  // < 0: timed out
+    };
+
+    void step();
+    void handleOverlayPainted(int arrowCount);
+    void handleTimeout();
+    void writeState(const QString &fen);
+    void report();
+
+    MainWindow *window;
+    Options options;
+    BoardWidget *site = nullptr;
+    QTimer *timeoutTimer = nullptr;
+    QString stateFile;
+    QVector<PackedPosition> positions;
+    QVector<Sample> samples;
+    int index = -1;
+    bool waiting = false;
+    bool expectArrows = false;
+    PackedPosition expectedPosition;
+    qint64 shownAt = 0;
+    QElapsedTimer clock;
+};
+
+#endif // LATENCYBENCHMARK_H
@@ -0,0 +1,35 @@
+#include "latencystats.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyStats LatencyStats::of(QVector<double> samples) {
+    LatencyStats stats;
+    if (samples.isEmpty())
+        return stats;
+    std::sort(samples.begin(), samples.end());
+
+    auto percentile = [&samples](double p) {
+        int rank = int(std::ceil(p / 100.0 * samples.size()));
+        return samples.at(std::clamp(rank - 1, 0, int(samples.size()) - 1));
+    };
+
+    double sum = 0.0;
+    for (double v : samples)
+        sum += v;
+    stats.count = samples.size();
+    stats.mean = sum / samples.size();
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    stats.p99 = percentile(99);
+    stats.max = samples.last();
+    return stats;
+}
+
+QString LatencyStats::summary() const {
+    return QString("mean %1 ms  p50 %2 ms  p90 %3 ms  p99 %4 ms  max %5 ms")
+        .arg(mean, 0, 'f', 1)
+        .arg(p50, 0, 'f', 1)
+        .arg(p90, 0, 'f', 1)
+        .arg(p99, 0, 'f', 1)
+        .arg(max, 0, 'f', 1);
+}
@@ -0,0 +1,24 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QString>
+#include <QVector>
+
+// Summary of a set of timings in milliseconds, shared by the latency bench,
+// session replay and detector bench reports. Percentiles are nearest-rank.
+struct LatencyStats {
+    int count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+
+    // samples need not be sorted; all zero if there are none.
+    static LatencyStats of(QVector<double> samples);
+
+    // "mean 1.0 ms  p50 1.0 ms  p90 1.0 ms  p99 1.0 ms  max 1.0 ms"
+    QString summary() const;
+};
+
+#endif // LATENCYSTATS_H
@@ -2,14 +2,36 @@
 #include <QFontDatabase>
 #include <QFile>
 #include <QStyleFactory>
+#include <QCommandLineParser>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QThread>
 #include "mainwindow.h"
+#include "latencybenchmark.h"
+#include "sessionreplay.h"
+#include "startuptimeline.h"
 
 int main(int argc, char *argv[])
 {
+    StartupTimeline::start();
     QApplication::setAttribute(Qt::AA_UseDesktopOpenGL); // This is OK before
 
     QApplication a(argc, argv);  // MUST come before all Qt setup
 
+    // Font and stylesheet are read from disk while the window is built;
+    // they are applied just before it is shown.
+    QByteArray fontData;
+    QByteArray styleData;
+    QThread *assetReader = QThread::create([&fontData, &styleData]() {
+        QFile fontFile("assets/fonts/Inter-Regular.ttf");
+        if (fontFile.open(QFile::ReadOnly))
+            fontData = fontFile.readAll();
+        QFile styleFile("assets/style.qss");
+        if (styleFile.open(QFile::ReadOnly))
+            styleData = styleFile.readAll();
+    });
+    assetReader->start();
+
     // Style and palette setup
     QApplication::setStyle(QStyleFactory::create("Fusion"));
     QPalette palette;
@@ -29,8 +51,34 @@ int main(int argc, char *argv[])
 
     a.setPalette(palette);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption benchLatency("bench-latency",
+        "Measure glass-to-arrow latency on a scripted game, then exit.");
+    QCommandLineOption benchMoves("bench-moves",
+        "UCI moves (whitespace separated) for --bench-latency.", "file");
+    QCommandLineOption benchMockRecognizer("bench-mock-recognizer",
+        "Answer frames with the scripted position instead of running the model.");
+    QCommandLineOption benchMockEngine("bench-mock-engine",
+        "Use the deterministic mock UCI engine.");
+    QCommandLineOption benchOutput("bench-output",
+        "Write per-position latencies as CSV.", "file");
+    QCommandLineOption replay("replay",
+        "Feed a recorded session log through recognition and tracking, report, then exit.", "file");
+    QCommandLineOption replaySpeed("replay-speed",
+        "1x (recorded frame spacing, default) or max.", "speed", "1x");
+    parser.addOptions({benchLatency, benchMoves, benchMockRecognizer, benchMockEngine, benchOutput,
+                       replay, replaySpeed});
+    parser.process(a);
+
+    MainWindow w;
+    StartupTimeline::mark("window built");
+
+    assetReader->wait();
+    delete assetReader;
+
     // Load custom font
-    int fontId = QFontDatabase::addApplicationFont("assets/fonts/Inter-Regular.ttf");
+    int fontId = fontData.isEmpty() ? -1 : QFontDatabase::addApplicationFontFromData(fontData);
     if (fontId != -1) {
         QString family = QFontDatabase::applicationFontFamilies(fontId).at(0);
         QFont font(family, 10);
@@ -38,13 +86,42 @@ int main(int argc, char *argv[])
     }
 
     // Load QSS stylesheet
-    QFile styleFile("assets/style.qss");
-    if (styleFile.open(QFile::ReadOnly)) {
-        QString style = QLatin1String(styleFile.readAll());
-        a.setStyleSheet(style);
-    }
+    if (!styleData.isEmpty())
+        a.setStyleSheet(QLatin1String(styleData));
 
-    MainWindow w;
     w.show();
+    StartupTimeline::mark("window shown");
+
+    if (parser.isSet(benchLatency)) {
+        LatencyBenchmark::Options options;
+        options.mockRecognizer = parser.isSet(benchMockRecognizer);
+        options.mockEngine = parser.isSet(benchMockEngine);
+        options.outputPath = parser.value(benchOutput);
+        if (options.mockRecognizer)
+            options.warmupMs = 1000;
+        if (parser.isSet(benchMoves)) {
+            QFile movesFile(parser.value(benchMoves));
+            if (!movesFile.open(QFile::ReadOnly | QFile::Text)) {
+                QTextStream(stderr) << "Cannot read " << parser.value(benchMoves) << "\n";
+                return 2;
+            }
+            options.moves = QString::fromUtf8(movesFile.readAll())
+                                .split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        }
+
+        LatencyBenchmark *bench = new LatencyBenchmark(&w, options, &w);
+        QObject::connect(bench, &LatencyBenchmark::finished, &a, &QCoreApplication::exit,
+                         Qt::QueuedConnection);
+        bench->start();
+    } else if (parser.isSet(replay)) {
+        SessionReplay::Options options;
+        options.path = parser.value(replay);
+        options.maxSpeed = parser.value(replaySpeed) == "max";
+        SessionReplay *sessionReplay = new SessionReplay(&w, options, &w);
+        QObject::connect(sessionReplay, &SessionReplay::finished, &a, &QCoreApplication::exit,
+                         Qt::QueuedConnection);
+        sessionReplay->start();
+    }
+
     return a.exec();
 }
@@ -13,19 +13,26 @@
 #include <QLabel>
 #include <QDebug>
 #include <QShortcut>
-#include <QScrollBar>
 #include <QStatusBar>
 #include <QMessageBox>
 #include <QPainter>
 #include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QPointer>
 #include "globalhotkeymanager.h"
 #include "settingsdialog.h"
+#include "chessposition.h"
+#include "boarddecoder.h"
+#include "startuptimeline.h"
 #include <QSettings>
 #include <QStandardPaths>
 #include <QThread>
 #include <QEasingCurve>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
+#include <memory>
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -38,14 +45,19 @@ MainWindow::MainWindow(QWidget *parent)
     stockfishDepth = settings.value("stockfishDepth", 15).toInt();
     autoMoveDelayMs = settings.value("autoMoveDelay", 0).toInt();
     autoMoveWhenReady = settings.value("autoMoveWhenReady", false).toBool();
-    boardTurnColor = "w";
     useAutoBoardDetectionSetting = settings.value("autoBoardDetection", true).toBool();
     forceManualRegionSetting = settings.value("forceManualRegion", false).toBool();
+    trackBoardSetting = settings.value("trackBoard", true).toBool();
+    recordSessionSetting = settings.value("recordSessions", false).toBool();
     stockfishPath = settings.value("stockfishPath",
         QCoreApplication::applicationDirPath() + "/stockfish.exe").toString();
+    engineKind = settings.value("engineBackend", EngineBackend::Stockfish).toInt();
+    arrowLines = settings.value("arrowLines", 1).toInt();
+    pvArrowPlies = settings.value("pvArrowPlies", 0).toInt();
+    uiRefreshRate = settings.value("uiRefreshRate", 0).toInt();
     fenModelPath = settings.value("fenModelPath",
         QCoreApplication::applicationDirPath() +
-        "/python/fen_tracker/ccn_model_default.pth").toString();
+        "/python/fen_tracker/models.json").toString();
 
     ui->automoveCheck->setChecked(autoMoveWhenReady);
     ui->stealthCheck->setChecked(settings.value("stealthMode", false).toBool());
@@ -98,13 +110,25 @@ MainWindow::MainWindow(QWidget *parent)
     });
 #endif
 
-    fenServer = new QProcess(this);
-    startFenServer();
+    pipelineClock.start();
+
+    // Subsystem readiness, right of the status bar messages.
+    recognizerStatus = new QLabel(this);
+    engineStatus = new QLabel(this);
+    firstFenLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(recognizerStatus);
+    statusBar()->addPermanentWidget(engineStatus);
+    statusBar()->addPermanentWidget(firstFenLabel);
+    setSubsystemState(recognizerStatus, tr("Recognizer"), SubsystemStarting);
+    setSubsystemState(engineStatus, tr("Engine"), SubsystemStarting);
+
     board = new BoardWidget();
     QVBoxLayout* layout = new QVBoxLayout(ui->chessBoardFrame);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->addWidget(board);
     board->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    evalGraph = new EvalGraphWidget();
+    layout->addWidget(evalGraph);
     evalScoreLabel = new QLabel(ui->evalBar);
 
     evalScoreLabel->setObjectName("evalBarOverlay");
@@ -126,9 +150,12 @@ MainWindow::MainWindow(QWidget *parent)
 
 
     evalScoreLabel->show();
+    ui->evalBar->setRange(-1000, 1000);
     evalAnimation = new QVariantAnimation(this);
     evalAnimation->setDuration(300);
-    evalAnimation->setEasingCurve(QEasingCurve::InOutQuad);
+    // Retargeted every frame while the engine deepens, so ease out only:
+    // an ease-in would restart slow on each new target.
+    evalAnimation->setEasingCurve(QEasingCurve::OutCubic);
     connect(evalAnimation, &QVariantAnimation::valueChanged, this, [=](const QVariant &v) {
         ui->evalBar->setValue(v.toInt());
     });
@@ -136,19 +163,39 @@ MainWindow::MainWindow(QWidget *parent)
     updateEvalLabel();
     connect(ui->evalBar, &QProgressBar::valueChanged, this, &MainWindow::updateEvalLabel);
     ui->fenDisplay->setPlainText("Waiting for FEN...");
+
+    engineState = new EngineStateModel(this);
+    engineState->setRefreshRate(uiRefreshRate);
+    connect(engineState, &EngineStateModel::snapshotChanged, this, &MainWindow::applyEngineSnapshot);
+
     screenshotTimer = new QTimer(this);
     connect(screenshotTimer, &QTimer::timeout, this, &MainWindow::captureScreenshot);
 
     settingsDialog = new SettingsDialog(this);
     settingsDialog->setAnalysisInterval(analysisInterval);
     settingsDialog->setStockfishDepth(stockfishDepth);
+    moveList = new MoveListModel(this);
+    ui->moveListView->setModel(moveList);
+    connect(ui->moveListView, &QListView::clicked, this, &MainWindow::jumpToMove);
+    QShortcut* endReview = new QShortcut(QKeySequence(Qt::Key_Escape), ui->moveListView);
+    endReview->setContext(Qt::WidgetShortcut);
+    connect(endReview, &QShortcut::activated, this, &MainWindow::returnToLive);
     connect(settingsDialog, &SettingsDialog::resetPgnRequested, this, [=]() {
-        moveHistoryLines.clear();
-        ui->pgnDisplay->clear();
+        moveList->clear();
     });
     connect(ui->actionOpen_Settings, &QAction::triggered, this, &MainWindow::openSettings);
 
-    startStockfish();  // Launch Stockfish engine
+    // Launch the recognizer and the engine once the window is on screen;
+    // both come up in their own processes while the UI is already usable.
+    // Whatever replaced them in the meantime (the latency bench's mocks)
+    // is left alone.
+    QTimer::singleShot(0, this, [this]() {
+        StartupTimeline::mark("event loop");
+        if (!fenServer)
+            startFenServer();
+        if (!engine)
+            startEngine();
+    });
 
 
     connect(ui->whiteRadioButton, &QRadioButton::toggled, this, [=](bool checked) {
@@ -160,6 +207,8 @@ MainWindow::MainWindow(QWidget *parent)
             if (fenServer && fenServer->state() == QProcess::Running) {
                 fenServer->write("[color] w\n");
             }
+            if (recorder.isOpen())
+                recorder.recordSessionInfo('w', analysisInterval);
         }
     });
     connect(ui->blackRadioButton, &QRadioButton::toggled, this, [=](bool checked) {
@@ -171,92 +220,10 @@ MainWindow::MainWindow(QWidget *parent)
             if (fenServer && fenServer->state() == QProcess::Running) {
                 fenServer->write("[color] b\n");
             }
+            if (recorder.isOpen())
+                recorder.recordSessionInfo('b', analysisInterval);
         }
     });
-
-
-    connect(fenServer, &QProcess::readyReadStandardOutput, this, [=]() {
-        QStringList lines = QString::fromUtf8(fenServer->readAllStandardOutput()).split("\n", Qt::SkipEmptyParts);
-        for (const QString& rawLine : lines) {
-            QString output = rawLine.trimmed();
-
-            qDebug() << "[raw output]" << output;
-
-            if (output == "ready") {
-                qDebug() << "[fen_server] Ready";
-                return;
-            }
-
-            if (output.startsWith("[error]")) {
-                qDebug() << "[fen_server] Error:" << output;
-                return;
-
-            }
-
-            if (output.startsWith("[skip]")) {
-                qDebug() << "[fen_server] Skipped duplicate frame — no update";
-                return;  // ✅ DO NOT render or evaluate
-            }
-
-
-            if (output.startsWith("[FEN] ")) {
-                QString fen = output.mid(6);  // Skip "[FEN] "
-                QString pieceLayout = fen.section(" ", 0, 0);
-                QString turnColor = fen.section(" ", 1, 1);
-                boardTurnColor = turnColor;
-                qDebug() << "[timing] FEN processing:" << fenElapsed.elapsed() << "ms";
-
-                isMyTurn = (getMyColor() == turnColor);
-                bool fenChanged = (lastFen != fen);
-
-                if (!lastFen.isEmpty() && fenChanged) {
-                    QString uci = detectUciMove(lastFen, fen);
-                    bool whiteMoved = lastFen.section(' ', 1, 1) == "w";
-                    pendingEvalLine = addMoveToHistory(uci, whiteMoved);
-                    bool weMoved = lastFen.section(' ', 1, 1) == getMyColor();
-                    if (weMoved) {
-                        lastOwnMove = uci;
-                        lastPlayedFen = fen;
-                    }
-                }
-
-                qDebug() << "[gui] Received FEN:" << fen;
-                qDebug() << "[gui] Piece layout:" << pieceLayout;
-                qDebug() << "[gui] Passing to board: flipped =" << (getMyColor() == "b");
-
-                if (board) {
-                    board->setPositionFromFen(pieceLayout, getMyColor() == "b");
-                    if (!isMyTurn) {
-                        board->setArrows({});
-                    }
-                }
-
-                if (fenChanged && !isMyTurn) {
-                    ui->bestMoveDisplay->clear();  // ✅ Only clear if FEN changed and it's not your turn
-                }
-
-                if (fenChanged) {
-                    evaluatePosition(fen);
-                }
-
-                if (isMyTurn) {
-                    statusBar()->showMessage("My turn — analyzing...");
-                    updateStatusLabel("My turn — analyzing...");
-                    setStatusLight("green");
-                } else {
-                    statusBar()->showMessage("Opponent's turn — analyzing...");
-                    updateStatusLabel("Opponent's turn — analyzing...");
-                    setStatusLight("red");
-                }
-
-                lastFen = fen;
-                repetitionTable[fen] = repetitionTable.value(fen, 0) + 1;
-                ui->fenDisplay->setPlainText(fen);
-            }
-        }
-    });
-
-
 }
 
 MainWindow::~MainWindow()
@@ -270,10 +237,8 @@ MainWindow::~MainWindow()
         fenServer->kill();
         fenServer->waitForFinished(3000);
     }
-    if (stockfishProcess && stockfishProcess->state() != QProcess::NotRunning) {
-        stockfishProcess->kill();
-        stockfishProcess->waitForFinished(3000);
-    }
+    if (engine)
+        engine->stop();
     delete ui;
 }
 
@@ -287,29 +252,78 @@ void logToFile(const QString &msg) {
 }
 
 
+// The bundled interpreter on Windows, the system one elsewhere.
+static QString pythonExecutable() {
+    QString embeddedPython = QCoreApplication::applicationDirPath() + "/python/python.exe";
+    if (QFile::exists(embeddedPython))
+        return embeddedPython;
+#ifdef Q_OS_WIN
+    return QStringLiteral("python");
+#else
+    return QStringLiteral("python3");
+#endif
+}
+
+
+void MainWindow::setCaptureRegion(const QRect& region, const BoardGeometry& grid) {
+    captureRegion = region;
+    captureGrid = grid;
+    boardTracker.reset(region);
+    // Possibly another site or theme: the recognizer re-picks its model.
+    if (fenServer && fenServer->state() == QProcess::Running)
+        fenServer->write("[region]\n");
+}
+
+// The board no longer lines up with captureRegion: search near the old
+// region first and fall back to full-screen detection only if that fails.
+bool MainWindow::recoverBoard() {
+    QScreen* screen = screenForRegion(captureRegion);
+    if (!screen)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QRect area = boardTracker.searchArea(screen->geometry());
+    QImage areaImage = grabScreenRegion(area).toImage();
+    if (boardTracker.relocalize(areaImage, area)) {
+        QRect region = boardTracker.region();
+        QImage check = grabScreenRegion(region).toImage();
+        if (boardTracker.confirm(check)) {
+            if (captureGrid.isValid())
+                captureGrid = captureGrid.mapped(captureRegion, region);
+            captureRegion = region;
+            qDebug() << "[tracker] Re-aligned to" << region << "in" << timer.elapsed() << "ms";
+            statusBar()->showMessage(QString("Board moved - re-aligned in %1 ms").arg(timer.elapsed()));
+            return true;
+        }
+    }
+
+    QVector<ScreenBoard> boards = detectBoardsOnAllScreens(frameGeometry());
+    if (!boards.isEmpty()) {
+        QRect detected = boards.first().region();
+        setCaptureRegion(detected, boards.first().geometry);
+        qDebug() << "[tracker] Re-detected board at" << detected << "in" << timer.elapsed() << "ms";
+        statusBar()->showMessage(QString("Board lost - re-detected in %1 ms").arg(timer.elapsed()));
+        return true;
+    }
+
+    qDebug() << "[tracker] Board lost";
+    statusBar()->showMessage("Board lost - set the region again");
+    updateStatusLabel("Board lost");
+    return false;
+}
+
 void MainWindow::on_setRegionButton_clicked() {
-    QScreen* screen = QGuiApplication::primaryScreen();
-    QPixmap screenPixmap = screen->grabWindow(0);
-    QImage screenshot = screenPixmap.toImage();
-
-    // Mask out this application's window so detection ignores it
-    double dpr = screenshot.devicePixelRatio();
-    QRect windowRect = frameGeometry();
-    QRect scaledRect(windowRect.x() * dpr,
-                     windowRect.y() * dpr,
-                     windowRect.width() * dpr,
-                     windowRect.height() * dpr);
-    QPainter maskPainter(&screenshot);
-    maskPainter.fillRect(scaledRect, Qt::black);
-    maskPainter.end();
-
-    QRect detected;
+    QVector<ScreenBoard> boards;
     if (useAutoBoardDetectionSetting && !forceManualRegionSetting)
-        detected = detectChessboard(screenshot);
-    qDebug() << "Detected chessboard region:" << detected;
+        boards = detectBoardsOnAllScreens(frameGeometry());
 
-    if (!detected.isNull()) {
-        autoDetectedRegion = detected;
+    if (!boards.isEmpty()) {
+        const ScreenBoard& detected = boards.first();
+        autoDetectedRegion = detected.region();
+        autoDetectedGrid = detected.geometry;
+        qDebug() << "Detected chessboard region:" << autoDetectedRegion << "on" << detected.screen->name();
 
         // If a previous overlay exists, clean it up
         if (autoOverlay) {
@@ -322,14 +336,14 @@ void MainWindow::on_setRegionButton_clicked() {
         class OverlayPainter : public QDialog {
         public:
             QRect highlight;
-            OverlayPainter(QRect rect)
+            OverlayPainter(QRect rect, QScreen* screen)
                 : QDialog(nullptr, Qt::FramelessWindowHint | Qt::Tool | Qt::WindowStaysOnTopHint | Qt::Window)
-                , highlight(rect)
+                , highlight(rect.translated(-screen->geometry().topLeft()))
             {
                 setAttribute(Qt::WA_TranslucentBackground);
                 setFocusPolicy(Qt::StrongFocus);
                 setModal(true);  // ✅ This grabs all keyboard input
-                setGeometry(QGuiApplication::primaryScreen()->geometry());
+                setGeometry(screen->geometry());
             }
 
         protected:
@@ -346,7 +360,7 @@ void MainWindow::on_setRegionButton_clicked() {
         };
 
         // Instantiate overlay
-        autoOverlay = new OverlayPainter(detected);
+        autoOverlay = new OverlayPainter(autoDetectedRegion, detected.screen);
         autoOverlay->installEventFilter(this);
 
         // Force delayed focus grab after event loop returns
@@ -362,9 +376,22 @@ void MainWindow::on_setRegionButton_clicked() {
 
     } else {
         // Fallback: Manual selection
-        RegionSelector* selector = new RegionSelector();
-        connect(selector, &RegionSelector::regionSelected, this, [=](const QRect& region) {
-            captureRegion = region;
+        selectRegionManually();
+    }
+}
+
+// One selector per screen; the first selection made closes the others.
+void MainWindow::selectRegionManually() {
+    auto selectors = std::make_shared<QList<QPointer<RegionSelector>>>();
+    for (QScreen* screen : QGuiApplication::screens()) {
+        RegionSelector* selector = new RegionSelector(screen);
+        selectors->append(selector);
+        connect(selector, &RegionSelector::regionSelected, this, [this, selectors](const QRect& region) {
+            for (const QPointer<RegionSelector>& other : *selectors) {
+                if (other)
+                    other->close();
+            }
+            setCaptureRegion(region);
             statusBar()->showMessage("Manual region set.");
             updateStatusLabel("Manual region set.");
         });
@@ -382,223 +409,303 @@ void MainWindow::captureScreenshot() {
 
     if (captureRegion.isNull()) return;
 
-    QScreen* screen = QGuiApplication::primaryScreen();
-    if (!screen) return;
-
     screenshotElapsed.restart();
 
-    QPixmap fullShot = screen->grabWindow(0,
-                                          captureRegion.x(),
-                                          captureRegion.y(),
-                                          captureRegion.width(),
-                                          captureRegion.height());
+    QPixmap fullShot = grabScreenRegion(captureRegion);
+    if (fullShot.isNull()) return;
 
-    QPixmap resized = fullShot.scaled(256, 256, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    QImage image = resized.toImage().convertToFormat(QImage::Format_RGB888);
+    if (trackBoardSetting &&
+        boardTracker.verify(fullShot.toImage()) == BoardTracker::Drifted) {
+        if (!recoverBoard())
+            return;
+        fullShot = grabScreenRegion(captureRegion);
+    }
+
+    // A detected board is cut along its own grid lines into exact 32 px
+    // squares; a manual region has no lattice and is scaled as a whole.
+    QImage image;
+    if (captureGrid.isValid())
+        image = resampleBoardSquares(fullShot.toImage(), captureRegion, captureGrid);
+    else
+        image = fullShot.scaled(256, 256, Qt::KeepAspectRatio, Qt::SmoothTransformation).toImage();
+    image = image.convertToFormat(QImage::Format_RGB888);
 
     statusBar()->showMessage("Board changed → ready to analyze");
+    submitFrame(image);
+    qDebug() << "[timing] Screenshot capture:" << screenshotElapsed.elapsed() << "ms";
+}
+
+// Hands a 256x256 frame to the recognizer; live captures and SessionReplay
+// both come through here. Returns the frame's sequence, 0 if not sent.
+quint32 MainWindow::submitFrame(const QImage& image) {
     QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
     QString imagePath = QDir(tempDir).filePath("chessgui_last_screenshot.png");
-    image.save(imagePath);
-    qDebug() << "[timing] Screenshot capture:" << screenshotElapsed.elapsed() << "ms";
-    qDebug() << "[runFenPrediction] Sending image path:" << imagePath;
-    runFenPrediction(imagePath);
 
+    if (recordSessionSetting && !replaying && !recorder.isOpen() &&
+        !recorder.open(SessionRecorder::defaultPath(), getMyColor().at(0).toLatin1(), analysisInterval))
+        recordSessionSetting = false;  // warned once, not on every frame
+    if (!recorder.isOpen()) {
+        image.save(imagePath);
+        return runFenPrediction(imagePath);
+    }
 
+    // Encoded once, for the recognizer and the recording.
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    QFile imageFile(imagePath);
+    if (imageFile.open(QIODevice::WriteOnly))
+        imageFile.write(png);
+    imageFile.close();
+    quint32 seq = runFenPrediction(imagePath);
+    if (seq)
+        recorder.recordFrame(seq, png);
+    return seq;
 }
 
-void MainWindow::startStockfish() {
-    restartStockfishOnCrash = true;
-    stockfishProcess = new QProcess(this);
-
-    QProcess* proc = stockfishProcess;
+void MainWindow::startEngine() {
+    if (engine) {
+        engine->disconnect(this);
+        engine->stop();
+        engine->deleteLater();
+    }
 
-    connect(proc, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this, proc](int, QProcess::ExitStatus exitStatus) {
-                bool shouldRestart = (proc == stockfishProcess) &&
-                                     restartStockfishOnCrash &&
-                                     exitStatus == QProcess::CrashExit;
-                proc->deleteLater();
-                if (proc == stockfishProcess)
-                    stockfishProcess = nullptr;
-                if (shouldRestart) {
-                    statusBar()->showMessage("Stockfish crashed - restarting");
-                    updateStatusLabel("Stockfish crashed - restarting");
-                    QTimer::singleShot(0, this, &MainWindow::startStockfish);
-                }
-            });
+    engine = EngineBackend::create(EngineBackend::Kind(engineKind), stockfishPath, this);
+    setSubsystemState(engineStatus, tr("Engine"), SubsystemStarting);
+    connect(engine, &EngineBackend::ready, this, [this]() {
+        StartupTimeline::mark("engine ready");
+        setSubsystemState(engineStatus, tr("Engine"), SubsystemReady);
+    });
+    connect(engine, &EngineBackend::infoReceived, this, &MainWindow::handleEngineInfo);
+    connect(engine, &EngineBackend::bestMoveReceived, this, &MainWindow::handleBestMove);
+    connect(engine, &EngineBackend::crashed, this, [this]() {
+        statusBar()->showMessage("Engine crashed - restarting");
+        updateStatusLabel("Engine crashed - restarting");
+        QTimer::singleShot(0, this, &MainWindow::startEngine);
+    });
 
-    connect(proc, &QProcess::errorOccurred, this,
-            [this, proc](QProcess::ProcessError error) {
-                bool shouldRestart = (proc == stockfishProcess) &&
-                                     restartStockfishOnCrash &&
-                                     error == QProcess::Crashed;
-                if (shouldRestart) {
-                    statusBar()->showMessage("Stockfish crashed - restarting");
-                    updateStatusLabel("Stockfish crashed - restarting");
-                    proc->deleteLater();
-                    stockfishProcess = nullptr;
-                    QTimer::singleShot(0, this, &MainWindow::startStockfish);
-                }
-            });
+    if (!engine->start()) {
+        qDebug() << "Failed to start engine" << EngineBackend::kindName(EngineBackend::Kind(engineKind));
+        setSubsystemState(engineStatus, tr("Engine"), SubsystemFailed);
+        return;
+    }
+    StartupTimeline::mark("engine launched");
+    engine->newGame();  // fresh hash *once*
+}
 
-    stockfishProcess->start(this->stockfishPath, QStringList{});
+void MainWindow::handleBestMove(const QString& bestMove) {
+    qDebug() << "[timing] Engine evaluation:" << evalElapsed.elapsed() << "ms";
+    if (recorder.isOpen())
+        recorder.recordEngineResult(evaluatedPosition, bestMove, engineState->snapshot());
+    if (StartupTimeline::at("first best move") < 0) {
+        StartupTimeline::mark("first best move");
+        qDebug().noquote() << "[startup] Timeline:\n" + StartupTimeline::summary();
+    }
 
+    QString reverseMove;
+    if (lastOwnMove.length() >= 4)
+        reverseMove = lastOwnMove.mid(2, 2) + lastOwnMove.mid(0, 2);
+
+    // Undoing our last move would reach a position seen twice already:
+    // search the other moves instead of walking into a repetition draw.
+    ChessMove reverse;
+    if (!reverseMove.isEmpty() && bestMove == reverseMove && !game.isEmpty())
+        reverse = game.position().parseUciMove(reverseMove.toStdString());
+    if (!reverse.isNull() && game.repetitionsAfter(reverse) >= 2 &&
+        engine && engine->isRunning()) {
+
+        QStringList legalMoves;
+        ChessMoveList list;
+        game.position().generateLegalMoves(list);
+        for (const ChessMove& m : list)
+            legalMoves << QString::fromStdString(ChessPosition::moveToUci(m));
+
+        legalMoves.removeAll(reverseMove);
+        if (legalMoves.isEmpty()) {
+            playMove(reverseMove);
+            return;
+        }
 
-    if (!stockfishProcess->waitForStarted()) {
-        qDebug() << "Failed to start Stockfish";
+        engine->analyse(QString::fromStdString(livePosition.fen()), stockfishDepth, legalMoves);
         return;
     }
 
-    // ----- one-time UCI handshake & options -----
-    stockfishProcess->write("uci\n");
-    stockfishProcess->waitForReadyRead(200);                    // read to “uciok”
-    stockfishProcess->write("ucinewgame\n");                    // fresh hash *once*
-
+    MoveChoice choice = pickBestMove(ui->stealthCheck->isChecked());
+    if (choice.move.isEmpty()) {
+        choice.move = bestMove;
+        choice.rank = 1;
+    }
+    selectedBestMoveRank = choice.rank;
+    multipvMoves.clear();
 
-    connect(stockfishProcess, &QProcess::readyReadStandardOutput, this, [=]() {
-        QStringList lines = QString::fromUtf8(stockfishProcess->readAllStandardOutput()).split("\n", Qt::SkipEmptyParts);
+    if (ui->stealthCheck->isChecked())
+        qDebug() << "[stealth] Move" << choice.move << "score" << choice.score;
 
-        QRegularExpression bestMovePattern("bestmove ([a-h][1-8][a-h][1-8])");
-        QRegularExpression matePattern("score mate (-?\\d+)");
-        QRegularExpression cpPattern("score cp (-?\\d+)");
-        QRegularExpression pvPattern(
-            "multipv\\s+(\\d+)\\s+.*score\\s+cp\\s+(-?\\d+)\\s+.*pv\\s+([a-h][1-8][a-h][1-8])");
+    if (evaluatedPosition == livePosition) {  // ✅ Ensures best move matches current board
+        recordEvaluation(engineState->snapshot());
+        currentBestMove = choice.move;
+        QString label = choice.move;
+        if (choice.rank > 1) {
+            label += QString(" (Move: %1)").arg(choice.rank);
+        }
+        ui->bestMoveDisplay->setText(label);
+
+        if (choice.move.length() == 4) {
+            QString from = choice.move.mid(0, 2);
+            QString to = choice.move.mid(2, 2);
+            if (liveArrows())
+                updateAnalysisArrows();
+            else if (!reviewing)
+                board->setArrows({ qMakePair(from, to) });
+
+            if (isMyTurn && ui->automoveCheck->isChecked() && evaluatedPosition == livePosition) {
+                playBestMove();  // ✅ Only play after fresh bestMove matches fresh FEN
+            }
+        }
+    } else {
+        qDebug() << "[Engine] Ignoring best move for stale FEN";
+    }
+}
 
-        for (const QString& line : lines) {
-            QString trimmed = line.trimmed();
+// Final score of the live position: annotates the move that led to it in
+// the PGN and in the move list (as the change for our side).
+void MainWindow::recordEvaluation(const EngineSnapshot& snapshot) {
+    if (!snapshot.hasScore)
+        return;
+    pgn.annotateLastMove(snapshot.whiteScore, snapshot.isMate);
 
-            QRegularExpressionMatch pvMatch = pvPattern.match(trimmed);
-            if (pvMatch.hasMatch()) {
-                int idx = pvMatch.captured(1).toInt();
-                int cp = pvMatch.captured(2).toInt();
-                QString mv = pvMatch.captured(3);
-                multipvMoves[idx] = qMakePair(mv, cp);
-            }
+    double whitePawns = snapshot.isMate ? (snapshot.whiteScore > 0 ? 10.0 : -10.0)
+                                        : std::clamp(snapshot.whiteScore / 100.0, -10.0, 10.0);
+    double evalForMe = getMyColor() == "w" ? whitePawns : -whitePawns;
+    if (pendingEvalLine >= 0 && lastEvalValid)
+        appendEvalChangeToHistory(pendingEvalLine, evalForMe - lastEvalForMe);
+    pendingEvalLine = -1;
+    lastEvalForMe = evalForMe;
+    lastEvalValid = true;
+}
 
-            QRegularExpressionMatch bestMoveMatch = bestMovePattern.match(trimmed);
-            if (bestMoveMatch.hasMatch()) {
-                QString bestMove = bestMoveMatch.captured(1);
-                qDebug() << "[timing] Stockfish evaluation:" << evalElapsed.elapsed() << "ms";
-
-                QString reverseMove;
-                if (lastOwnMove.length() >= 4)
-                    reverseMove = lastOwnMove.mid(2, 2) + lastOwnMove.mid(0, 2);
-
-                if (!reverseMove.isEmpty() && bestMove == reverseMove &&
-                    repetitionTable.value(lastFen) >= 2 &&
-                    stockfishProcess && stockfishProcess->state() == QProcess::Running) {
-
-                    stockfishProcess->write(QString("position fen %1\n").arg(lastFen).toUtf8());
-                    stockfishProcess->write("d\n");
-
-                    QString buffer;
-                    if (stockfishProcess->waitForReadyRead(150))
-                        buffer += QString::fromUtf8(stockfishProcess->readAllStandardOutput());
-                    int idx = buffer.indexOf("Legal moves:");
-                    QStringList legalMoves;
-                    if (idx != -1) {
-                        QString line = buffer.mid(idx).section(QLatin1Char('\n'), 0, 0);
-                        line = line.section(":", 1).trimmed();
-                        legalMoves = line.split(' ', Qt::SkipEmptyParts);
-                    }
-
-                    legalMoves.removeAll(reverseMove);
-                    if (legalMoves.isEmpty()) {
-                        playMove(reverseMove);
-                        updateRepetitionTable(lastFen, true);
-                        return;
-                    }
-
-                    QString cmd = QStringLiteral("position fen %1\nsearchmoves %2\ngo depth %3\n")
-                                       .arg(lastFen)
-                                       .arg(legalMoves.join(' '))
-                                       .arg(stockfishDepth);
-                    stockfishProcess->write(cmd.toUtf8());
-                    return;
-                }
+// Copies into `to`'s own buffer rather than sharing the engine's, which it
+// reuses for the next line. After a search's first lines `to` has room, so
+// per-line updates don't allocate.
+static void copyBytes(QByteArray& to, const char* data, int size) {
+    to.resize(size);
+    std::memcpy(to.data(), data, size_t(size));
+}
 
-                MoveChoice choice = pickBestMove(ui->stealthCheck->isChecked());
-                if (choice.move.isEmpty()) {
-                    choice.move = bestMove;
-                    choice.rank = 1;
-                }
-                selectedBestMoveRank = choice.rank;
-                multipvMoves.clear();
-
-                if (ui->stealthCheck->isChecked())
-                    qDebug() << "[stealth] Move" << choice.move << "score" << choice.score;
-
-                if (lastEvaluatedFen == lastFen) {  // ✅ Ensures best move matches current board
-                    currentBestMove = choice.move;
-                    QString label = choice.move;
-                    if (choice.rank > 1) {
-                        label += QString(" (Move: %1)").arg(choice.rank);
-                    }
-                    ui->bestMoveDisplay->setText(label);
-
-                    if (choice.move.length() == 4) {
-                        QString from = choice.move.mid(0, 2);
-                        QString to = choice.move.mid(2, 2);
-                        board->setArrows({ qMakePair(from, to) });
-
-                        if (isMyTurn && ui->automoveCheck->isChecked() && lastEvaluatedFen == lastFen) {
-                            playBestMove();  // ✅ Only play after fresh bestMove matches fresh FEN
-                        }
-                    }
-                } else {
-                    qDebug() << "[Stockfish] Ignoring best move for stale FEN";
-                }
-            }
+// Move `ply` (0 = first) of a raw space-separated pv, empty past its end.
+static QString pvMoveAt(const QByteArray& pv, int ply) {
+    int begin = 0;
+    for (;;) {
+        while (begin < pv.size() && pv.at(begin) == ' ')
+            ++begin;
+        if (begin >= pv.size())
+            return QString();
+        int end = pv.indexOf(' ', begin);
+        if (end < 0)
+            end = pv.size();
+        if (ply-- == 0)
+            return QString::fromLatin1(pv.constData() + begin, end - begin);
+        begin = end;
+    }
+}
 
+void MainWindow::handleEngineInfo(const EngineInfo& info) {
+    if (!info.hasScore)
+        return;
 
-            QRegularExpressionMatch mateMatch = matePattern.match(trimmed);
-            QRegularExpressionMatch cpMatch = cpPattern.match(trimmed);
+    // First move as bytes: pickBestMove() converts it once per best move.
+    if (!info.isMate && !info.pv.isEmpty()) {
+        auto& entry = multipvMoves[info.multipv];
+        int space = info.pv.indexOf(' ');
+        copyBytes(entry.first, info.pv.constData(), space < 0 ? info.pv.size() : space);
+        entry.second = info.score;
+    }
+    // Kept as bytes; updateAnalysisArrows() picks out the moves it draws
+    // once per frame.
+    if (!info.pv.isEmpty() && liveArrows())
+        copyBytes(pvLines[info.multipv], info.pv.constData(), info.pv.size());
 
-            // 0. Who is the engine talking about?  + = good for White
-            int povSign = (boardTurnColor == "b") ? -1 : 1;
+    // Widgets are refreshed from the model at most once per display frame.
+    engineState->updateFromInfo(info, livePosition.side == ChessPosition::Black);
+}
 
-            /* ---------- mate in N ---------- */
-            if (mateMatch.hasMatch()) {
-                int mateMoves = mateMatch.captured(1).toInt();     // Stockfish value
-                int whiteMate = povSign * mateMoves;               // re-oriented
-                QString txt   = QString("M%1").arg(whiteMate);
+void MainWindow::applyEngineSnapshot(const EngineSnapshot& snapshot) {
+    if (liveArrows())
+        updateAnalysisArrows();
 
-                ui->evalBar->setRange(-1000, 1000);
-                ui->evalBar->setValue(whiteMate > 0 ? +1000 : -1000);
+    if (!snapshot.hasScore)
+        return;
 
-                evalScoreLabel->setText(txt);
-                updateEvalLabel();
-                statusBar()->showMessage("Eval: " + txt);
-                updateStatusLabel("Eval: " + txt);
-            }
+    QString txt;
+    int barValue;
+    if (snapshot.isMate) {
+        txt = QString("M%1").arg(snapshot.whiteScore);
+        barValue = snapshot.whiteScore > 0 ? +1000 : -1000;
+    } else {
+        txt = QString::number(snapshot.whiteScore / 100.0, 'f', 2);
+        barValue = std::clamp(snapshot.whiteScore, -1000, 1000);
+    }
+    setEvalBarValue(barValue);
+    evalGraph->addSample(barValue);
 
-            /* ---------- centipawn ---------- */
-            else if (cpMatch.hasMatch()) {
-                int rawCp   = cpMatch.captured(1).toInt();         // Stockfish value
-                int whiteCp = povSign * rawCp;                     // re-oriented
-                QString txt = QString::number(whiteCp / 100.0, 'f', 2);
+    evalScoreLabel->setText(txt);
+    updateEvalLabel();
+    statusBar()->showMessage("Eval: " + txt);
+    updateStatusLabel("Eval: " + txt);
+}
 
-                ui->evalBar->setRange(-1000, 1000);
-                ui->evalBar->setValue(std::clamp(whiteCp, -1000, 1000));
+void MainWindow::updateAnalysisArrows() {
+    if (!board || reviewing)
+        return;
 
-                evalScoreLabel->setText(txt);
-                updateEvalLabel();
-                statusBar()->showMessage("Eval: " + txt);
-                updateStatusLabel("Eval: " + txt);
-            }
-        }
-    });
+    // Candidate moves, graded by MultiPV rank.
+    QVector<ArrowOverlay::Arrow> arrows;
+    for (int rank = 1; rank <= arrowLines; ++rank) {
+        const QString move = pvMoveAt(pvLines.value(rank), 0);
+        if (move.length() < 4)
+            continue;
+        ArrowOverlay::Arrow arrow;
+        arrow.from = move.mid(0, 2);
+        arrow.to = move.mid(2, 2);
+        QColor color("#66cc88");
+        color.setAlpha(rank == 1 ? 230 : qMax(90, 200 - rank * 30));
+        arrow.color = color;
+        arrow.weight = rank == 1 ? 1.0 : qMax(0.55, 1.0 - 0.15 * rank);
+        arrows.append(arrow);
+    }
 
+    // Continuation of the principal line: replies in orange, our follow-ups in blue.
+    const QByteArray principal = pvLines.value(1);
+    for (int ply = 1; ply <= pvArrowPlies; ++ply) {
+        const QString move = pvMoveAt(principal, ply);
+        if (move.length() < 4)
+            break;
+        ArrowOverlay::Arrow arrow;
+        arrow.from = move.mid(0, 2);
+        arrow.to = move.mid(2, 2);
+        QColor color = (ply % 2) ? QColor("#e0875f") : QColor("#66b3cc");
+        color.setAlpha(qMax(70, 190 - ply * 20));
+        arrow.color = color;
+        arrow.weight = qMax(0.45, 0.8 - 0.05 * ply);
+        arrows.append(arrow);
+    }
 
+    board->setArrowSet(arrows);
 }
 
 void MainWindow::startFenServer() {
-    restartFenServerOnCrash = true;
-
     if (fenServer) {
+        // Replacing a live server (e.g. switching to the mock recognizer)
+        // must not trigger the crash restart.
+        fenServer->disconnect(this);
+        if (fenServer->state() != QProcess::NotRunning) {
+            fenServer->kill();
+            fenServer->waitForFinished(3000);
+        }
         fenServer->deleteLater();
     }
+    restartFenServerOnCrash = true;
 
     fenServer = new QProcess(this);
     QProcess* proc = fenServer;
@@ -609,8 +716,11 @@ void MainWindow::startFenServer() {
                                      restartFenServerOnCrash &&
                                      exitStatus == QProcess::CrashExit;
                 proc->deleteLater();
-                if (proc == fenServer)
+                if (proc == fenServer) {
                     fenServer = nullptr;
+                    if (!shouldRestart)
+                        setSubsystemState(recognizerStatus, tr("Recognizer"), SubsystemFailed);
+                }
                 if (shouldRestart) {
                     statusBar()->showMessage("FEN server crashed - restarting");
                     updateStatusLabel("FEN server crashed - restarting");
@@ -632,24 +742,36 @@ void MainWindow::startFenServer() {
                 }
             });
 
-    QString scriptPath = QCoreApplication::applicationDirPath() + "/python/fen_tracker/main.py";
+    QString scriptPath = recognizerScript.isEmpty()
+        ? QCoreApplication::applicationDirPath() + "/python/fen_tracker/main.py"
+        : recognizerScript;
     QString color = getMyColor();  // This returns "w" or "b"
     QStringList arguments;
     arguments << scriptPath << "--color" << color;
+    if (recognizerScript.isEmpty() && !fenModelPath.isEmpty())
+        arguments << "--model" << fenModelPath;
+    serverModelPath = fenModelPath;
+    arguments << recognizerArguments;
 
     qDebug() << "[fenServer] Launching python with arguments:" << arguments;
 
-    QString embeddedPython = QCoreApplication::applicationDirPath() + "/python/python.exe";
-    proc->start(embeddedPython, arguments);
+    setSubsystemState(recognizerStatus, tr("Recognizer"), SubsystemStarting);
+    proc->start(pythonExecutable(), arguments);
 
     if (!proc->waitForStarted()) {
         qDebug() << "[fenServer] Failed to start";
+        setSubsystemState(recognizerStatus, tr("Recognizer"), SubsystemFailed);
         return;
     }
+    StartupTimeline::mark("recognizer launched");
 
     // ✅ Immediately send the color again in case user toggled it early
     proc->write(QString("[color] %1\n").arg(color).toUtf8());
 
+    recognizerParser.reset();
+    pendingFrames.clear();
+    connect(proc, &QProcess::readyReadStandardOutput, this, &MainWindow::readFenServerOutput);
+
     connect(fenServer, &QProcess::readyReadStandardError, this, [=]() {
         QString error = QString::fromUtf8(fenServer->readAllStandardError());
         qDebug() << "[fenServer stderr]" << error;
@@ -662,6 +784,174 @@ void MainWindow::startFenServer() {
 
 
 
+void MainWindow::readFenServerOutput() {
+    if (!fenServer)
+        return;
+    const QByteArray data = fenServer->readAllStandardOutput();
+    if (recorder.isOpen())
+        recorder.recordRecognizerOutput(data);
+    recognizerParser.append(data);
+    while (recognizerParser.next(recognizerMessage)) {
+        const RecognizerMessage& msg = recognizerMessage;
+        switch (msg.type) {
+        case RecognizerMessage::Ready:
+            // serverMicros: the server's own startup, imports to warm model.
+            qDebug() << "[fen_server] Ready after" << msg.serverMicros / 1000 << "ms in Python";
+            StartupTimeline::mark("recognizer ready");
+            setSubsystemState(recognizerStatus, tr("Recognizer"), SubsystemReady);
+            break;
+        case RecognizerMessage::Error:
+            pendingFrames.remove(msg.sequence);
+            qDebug() << "[fen_server] Error on frame" << msg.sequence << ":"
+                     << QString::fromUtf8(msg.text);
+            emit recognizerAnswered(msg);
+            break;
+        case RecognizerMessage::ModelSwapped:
+            serverModelPath = QString::fromUtf8(msg.text);
+            qDebug() << "[fen_server] Now using model" << serverModelPath;
+            statusBar()->showMessage(tr("Recognizer model loaded"), 4000);
+            break;
+        case RecognizerMessage::ModelRejected: {
+            // The settings dialog already saved the rejected path; left there,
+            // the next launch would pass it as --model and the recognizer
+            // would fail before Ready. Go back to the model still running.
+            QString rejected = fenModelPath;
+            qDebug() << "[fen_server] Model rejected:" << QString::fromUtf8(msg.text)
+                     << "- restoring" << serverModelPath;
+            fenModelPath = serverModelPath;
+            QSettings settings("ChessGUI", "ChessGUI");
+            settings.setValue("fenModelPath", fenModelPath);
+            if (settingsDialog)
+                settingsDialog->setFenModelPath(fenModelPath);
+            statusBar()->showMessage(tr("Recognizer model %1 rejected, keeping the previous one")
+                                         .arg(QFileInfo(rejected).fileName()), 6000);
+            break;
+        }
+        case RecognizerMessage::Skip:
+            pendingFrames.remove(msg.sequence);
+            emit recognizerAnswered(msg);
+            break;
+        case RecognizerMessage::Result:
+            handleFenResult(msg);
+            emit recognizerAnswered(msg);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void MainWindow::handleFenResult(const RecognizerMessage& msg) {
+    qint64 sentAt = pendingFrames.take(msg.sequence);
+    if (sentAt > 0) {
+        qDebug() << "[timing] frame" << msg.sequence << "round trip:"
+                 << (pipelineClock.nsecsElapsed() - sentAt) / 1000 << "us, server:"
+                 << msg.serverMicros << "us, inference:" << msg.inferenceMicros << "us";
+    }
+    if (msg.hasChangedSquares())
+        qDebug() << "[fen_server]" << qPopulationCount(msg.changedSquares) << "squares changed";
+    if (StartupTimeline::at("first FEN") < 0)
+        reportFirstFen();
+
+    // Prefer the most likely position one legal move away from the
+    // last confirmed one; a single misread square then can't
+    // produce a phantom position (and a wasted engine search).
+    ChessPosition observed;
+    bool haveObserved = false;
+    if (msg.hasProbabilities() && !game.isEmpty()) {
+        SquareProbabilities probs;
+        BoardDecoder::fromImageGrid(msg.probabilities, msg.flipped(), probs);
+        BoardDecoder::Result decoded = BoardDecoder::decode(game.position(), probs);
+        if (decoded.legal) {
+            observed = decoded.position;
+            haveObserved = true;
+        } else {
+            qDebug() << "[decoder] No legal position fits, using raw decode";
+        }
+    }
+    if (!haveObserved && !observed.setFromPacked(msg.position())) {
+        qDebug() << "[gui] Unreadable position from recognizer:" << msg.fen();
+        return;
+    }
+
+    // The tracker joins the observation to the game so far; its position
+    // carries the real castling rights, en passant square and move counters.
+    GameTracker::Change change = game.update(observed);
+    const PackedPosition position = game.position().packed();
+    if (change == GameTracker::Moved) {
+        pgn.addMove(game.lastMoveSan(), game.position());
+        ChessMoveList replies;
+        game.position().generateLegalMoves(replies);
+        if (replies.isEmpty())
+            pgn.finishGame(game.position().inCheck() ? "Checkmate" : "Stalemate");
+
+        if (game.isThreefoldRepetition()) {
+            qDebug() << "[game] Threefold repetition";
+            statusBar()->showMessage(tr("Threefold repetition - draw can be claimed"), 5000);
+        } else if (game.isFiftyMoveDraw()) {
+            qDebug() << "[game] Fifty-move rule";
+            statusBar()->showMessage(tr("Fifty moves without capture or pawn move - draw can be claimed"), 5000);
+        }
+    } else if (change == GameTracker::Resynced) {
+        if (!livePosition.isEmpty()) {
+            qDebug() << "[game] No single move leads here, resynchronised on"
+                     << QString::fromStdString(game.fen());
+        }
+        pgn.beginGame(game.position(), "Lost track of the game, continued in the next game");
+    }
+
+    qDebug() << "[timing] FEN processing:" << fenElapsed.elapsed() << "ms";
+
+    bool flipped = getMyColor() == "b";
+    isMyTurn = (position.side == ChessPosition::Black) == flipped;
+    bool fenChanged = (livePosition != position);
+
+    if (change == GameTracker::Moved) {
+        QString uci = QString::fromStdString(ChessPosition::moveToUci(game.lastMove()));
+        // The side to move now is the one that didn't just move.
+        bool whiteMoved = game.position().sideToMove() == ChessPosition::Black;
+        pendingEvalLine = addMoveToHistory(uci, whiteMoved, position);
+        bool weMoved = (whiteMoved ? "w" : "b") == getMyColor();
+        if (weMoved) {
+            lastOwnMove = uci;
+            lastPlayedPosition = position;
+        }
+    }
+
+    // A new position ends a review; an unchanged one leaves it on screen.
+    if (fenChanged)
+        reviewing = false;
+    if (board && !reviewing) {
+        board->setPosition(position, flipped);
+        if (!isMyTurn || (fenChanged && liveArrows())) {
+            board->setArrows({});
+        }
+    }
+
+    if (fenChanged && !isMyTurn) {
+        ui->bestMoveDisplay->clear();  // ✅ Only clear if FEN changed and it's not your turn
+    }
+
+    if (fenChanged) {
+        evalGraph->markPly();
+        evaluatePosition(position);
+    }
+
+    if (isMyTurn) {
+        statusBar()->showMessage("My turn — analyzing...");
+        updateStatusLabel("My turn — analyzing...");
+        setStatusLight("green");
+    } else {
+        statusBar()->showMessage("Opponent's turn — analyzing...");
+        updateStatusLabel("Opponent's turn — analyzing...");
+        setStatusLight("red");
+    }
+
+    livePosition = position;
+    if (!reviewing)
+        ui->fenDisplay->setPlainText(QString::fromStdString(position.fen()));
+}
+
 void MainWindow::on_toggleAnalysisButton_clicked() {
     if (analysisRunning) {
         screenshotTimer->stop();
@@ -681,6 +971,7 @@ void MainWindow::on_toggleAnalysisButton_clicked() {
         }
     }
 
+    StartupTimeline::mark("analysis started");
     screenshotTimer->start(analysisInterval);
     ui->toggleAnalysisButton->setText("Stop Analysis (Ctrl +A)");
     updateStatusLabel("Analyzing...");
@@ -688,37 +979,37 @@ void MainWindow::on_toggleAnalysisButton_clicked() {
     analysisRunning = true;
 }
 
-void MainWindow::runFenPrediction(const QString& imagePath) {
+quint32 MainWindow::runFenPrediction(const QString& imagePath) {
     if (!fenServer || fenServer->state() != QProcess::Running) {
         qDebug() << "[fen_server] Not running";
-        return;
+        return 0;
     }
 
     fenElapsed.restart();
-    QString toSend = imagePath + "\n";
-    fenServer->write(toSend.toUtf8());
+    quint32 seq = ++frameSequence;
+    pendingFrames.insert(seq, pipelineClock.nsecsElapsed());
+    // Frames the server never answers (e.g. after a restart) must not pile up.
+    if (pendingFrames.size() > 64)
+        pendingFrames.erase(pendingFrames.begin());
+    fenServer->write(QStringLiteral("[frame] %1 %2\n").arg(seq).arg(imagePath).toUtf8());
+    return seq;
 }
 
-void MainWindow::evaluatePosition(const QString& fen) {
-    lastEvaluatedFen = fen;
+void MainWindow::evaluatePosition(const PackedPosition& position) {
+    evaluatedPosition = position;
 
-    if (!stockfishProcess || stockfishProcess->state() != QProcess::Running)
+    if (!engine || !engine->isRunning())
         return;
 
     evalElapsed.restart();
 
-    QStringList commands = {
-        QString("setoption name MultiPV value %1").arg(ui->stealthCheck->isChecked() ? 3 : 1),
-        "position fen " + fen,
-        QString("go depth %1").arg(stockfishDepth)
-    };
-
     multipvMoves.clear();
+    pvLines.clear();
     selectedBestMoveRank = 1;
 
-    for (const QString& cmd : commands) {
-        stockfishProcess->write((cmd + "\n").toUtf8());
-    }
+    engine->setMultiPv(qMax(ui->stealthCheck->isChecked() ? 3 : 1, arrowLines));
+    // The UCI boundary: the only place the engine's FEN is produced.
+    engine->analyse(QString::fromStdString(position.fen()), stockfishDepth);
 }
 
 QString MainWindow::getMyColor() const {
@@ -731,7 +1022,7 @@ bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
     if (obj == autoOverlay && event->type() == QEvent::KeyPress) {
         QKeyEvent* keyEvent = static_cast<QKeyEvent*>(event);
         if (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter) {
-            captureRegion = autoDetectedRegion;
+            setCaptureRegion(autoDetectedRegion, autoDetectedGrid);
             autoOverlay->close();
             autoOverlay->deleteLater();
             autoOverlay = nullptr;
@@ -745,13 +1036,7 @@ bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
             statusBar()->showMessage("Cancelled — using manual selector.");
             updateStatusLabel("Cancelled — using manual selector.");
 
-            RegionSelector* selector = new RegionSelector();
-            connect(selector, &RegionSelector::regionSelected, this, [=](const QRect& region) {
-                captureRegion = region;
-                statusBar()->showMessage("Manual region set.");
-                updateStatusLabel("Manual region set.");
-            });
-            selector->show();
+            selectRegionManually();
 
             return true;
         }
@@ -776,6 +1061,30 @@ void MainWindow::updateStatusLabel(const QString& text) {
     ui->statusLabelEdit->setText(text);
 }
 
+void MainWindow::setSubsystemState(QLabel* label, const QString& name, SubsystemState state) {
+    if (!label)
+        return;
+    static const char* const colors[] = {"#FFC107", "#4CAF50", "#F44336"};
+    static const char* const words[] = {"starting", "ready", "failed"};
+    label->setText(QString("<span style=\"color:%1\">%2</span> %3")
+                       .arg(QLatin1String(colors[state]), QString(QChar(0x25CF)), name));
+    label->setToolTip(QString("%1 %2").arg(name, QLatin1String(words[state])));
+}
+
+// Launch to the first recognized position. Once the user has set things up
+// this is the cold start they feel, so it is shown as well as logged; the
+// tooltip has the whole timeline.
+void MainWindow::reportFirstFen() {
+    qint64 firstFen = StartupTimeline::mark("first FEN");
+    qint64 started = StartupTimeline::at("analysis started");
+    QString text = started >= 0
+        ? tr("First FEN %1 ms after start").arg(firstFen - started)
+        : tr("First FEN at %1 ms").arg(firstFen);
+    qDebug() << "[startup]" << text << "(launch +" << firstFen << "ms)";
+    firstFenLabel->setText(text);
+    firstFenLabel->setToolTip(StartupTimeline::summary());
+}
+
 void MainWindow::playBestMove() {
     if (currentBestMove.length() != 4 || automoveInProgress)
         return;
@@ -815,8 +1124,7 @@ void MainWindow::playBestMove() {
                     captureScreenshot();
                 });
 
-        QString embeddedPython = QCoreApplication::applicationDirPath() + "/python/python.exe";
-        moveProcess->start(embeddedPython, args);
+        moveProcess->start(pythonExecutable(), args);
 
 
         if (!moveProcess->waitForStarted()) {
@@ -839,13 +1147,6 @@ void MainWindow::playMove(const QString &uci) {
     currentBestMove = prev;
 }
 
-void MainWindow::updateRepetitionTable(const QString &fen, bool afterMove) {
-    if (afterMove)
-        repetitionTable[fen] = repetitionTable.value(fen, 0) + 1;
-    else if (repetitionTable.contains(fen) && repetitionTable.value(fen) > 0)
-        repetitionTable[fen] -= 1;
-}
-
 void MainWindow::updateEvalLabel() {
     if (!evalScoreLabel || !ui->evalBar) return;
 
@@ -872,82 +1173,66 @@ void MainWindow::setEvalBarValue(int value) {
             ui->evalBar->setValue(value);
         return;
     }
-    if (evalAnimation->state() == QVariantAnimation::Running)
+    if (evalAnimation->state() == QVariantAnimation::Running) {
+        if (evalAnimation->endValue().toInt() == value)
+            return;
         evalAnimation->stop();
+    }
     evalAnimation->setStartValue(ui->evalBar->value());
     evalAnimation->setEndValue(value);
     evalAnimation->start();
 }
 
-QString MainWindow::detectUciMove(const QString& prevFen, const QString& currFen) const {
-    auto parseBoard = [](const QString& layout) {
-        QVector<QVector<QChar>> board(8, QVector<QChar>(8, '.'));
-        QStringList ranks = layout.split('/');
-        for (int r = 0; r < qMin(8, ranks.size()); ++r) {
-            int c = 0;
-            for (QChar ch : ranks[r]) {
-                if (ch.isDigit()) {
-                    c += ch.digitValue();
-                } else {
-                    if (c < 8) board[r][c] = ch;
-                    ++c;
-                }
-            }
-        }
-        return board;
-    };
-
-    QString prevLayout = prevFen.section(' ', 0, 0);
-    QString currLayout = currFen.section(' ', 0, 0);
-    auto prevBoard = parseBoard(prevLayout);
-    auto currBoard = parseBoard(currLayout);
-
-    QString from, to;
-    for (int r = 0; r < 8; ++r) {
-        for (int c = 0; c < 8; ++c) {
-            if (prevBoard[r][c] != currBoard[r][c]) {
-                if (prevBoard[r][c] != '.' && currBoard[r][c] == '.') {
-                    from = QString(QChar('a' + c)) + QString::number(8 - r);
-                } else if (prevBoard[r][c] == '.' && currBoard[r][c] != '.') {
-                    to = QString(QChar('a' + c)) + QString::number(8 - r);
-                } else if (prevBoard[r][c] != currBoard[r][c] && currBoard[r][c] != '.') {
-                    to = QString(QChar('a' + c)) + QString::number(8 - r);
-                    if (from.isEmpty())
-                        from = QString(QChar('a' + c)) + QString::number(8 - r);
-                }
-            }
-        }
-    }
+int MainWindow::addMoveToHistory(const QString& moveUci, bool whiteMove, const PackedPosition& after) {
+    if (moveUci.isEmpty()) return -1;
 
-    if (!from.isEmpty() && !to.isEmpty())
-        return from + to;
-    return {};
+    int row = moveList->appendMove(moveUci, whiteMove, after);
+    ui->moveListView->scrollToBottom();
+    return row;
 }
 
-int MainWindow::addMoveToHistory(const QString& moveUci, bool whiteMove) {
-    if (moveUci.isEmpty()) return -1;
+void MainWindow::appendEvalChangeToHistory(int index, double delta) {
+    moveList->setEvalDelta(index, delta);
+}
 
-    int index = 0;
-    if (whiteMove || moveHistoryLines.isEmpty()) {
-        moveHistoryLines.append(QString::number(moveHistoryLines.size() + 1) + ". " + moveUci);
-        index = moveHistoryLines.size() - 1;
-    } else {
-        moveHistoryLines.last().append(" " + moveUci);
-        index = moveHistoryLines.size() - 1;
+void MainWindow::jumpToMove(const QModelIndex& index) {
+    PackedPosition position = moveList->positionAt(index.row());
+    if (position.isEmpty() || !board)
+        return;
+    if (position == livePosition) {
+        returnToLive();
+        return;
     }
 
-    ui->pgnDisplay->setPlainText(moveHistoryLines.join("\n"));
-    ui->pgnDisplay->verticalScrollBar()->setValue(ui->pgnDisplay->verticalScrollBar()->maximum());
-    return index;
+    // Review is display only: the engine keeps analysing the live position,
+    // and the eval bar and graph keep following it. Escape, clicking the
+    // latest move or the next live position from the capture ends it.
+    reviewing = true;
+    board->setPosition(position, getMyColor() == "b");
+    board->setArrows({});
+    ui->fenDisplay->setPlainText(QString::fromStdString(position.fen()));
+    statusBar()->showMessage(QString("Reviewing: %1 (Esc returns to the live board)").arg(index.data().toString()));
 }
 
-void MainWindow::appendEvalChangeToHistory(int index, double delta) {
-    if (index < 0 || index >= moveHistoryLines.size()) return;
-    QString sign = delta >= 0 ? "+" : "";
-    QString deltaStr = QString("%1%2").arg(sign).arg(QString::number(delta, 'f', 2));
-    moveHistoryLines[index].append(QString(" (%1)").arg(deltaStr));
-    ui->pgnDisplay->setPlainText(moveHistoryLines.join("\n"));
-    ui->pgnDisplay->verticalScrollBar()->setValue(ui->pgnDisplay->verticalScrollBar()->maximum());
+void MainWindow::returnToLive() {
+    if (!reviewing)
+        return;
+    reviewing = false;
+    ui->moveListView->clearSelection();
+    if (!board || livePosition.isEmpty())
+        return;
+
+    board->setPosition(livePosition, getMyColor() == "b");
+    if (!isMyTurn)
+        board->setArrows({});
+    else if (liveArrows())
+        updateAnalysisArrows();
+    else if (currentBestMove.length() == 4)
+        board->setArrows({ qMakePair(currentBestMove.mid(0, 2), currentBestMove.mid(2, 2)) });
+    else
+        board->setArrows({});
+    ui->fenDisplay->setPlainText(QString::fromStdString(livePosition.fen()));
+    statusBar()->clearMessage();
 }
 
 void MainWindow::openSettings()
@@ -957,22 +1242,38 @@ void MainWindow::openSettings()
     settingsDialog->setAnalysisInterval(analysisInterval);
     settingsDialog->setStockfishDepth(stockfishDepth);
     settingsDialog->setStealthModeEnabled(ui->stealthCheck->isChecked());
+    settingsDialog->setArrowLines(arrowLines);
+    settingsDialog->setPvArrowPlies(pvArrowPlies);
+    settingsDialog->setUiRefreshRate(uiRefreshRate);
     settingsDialog->setUseAutoBoardDetection(useAutoBoardDetectionSetting);
     settingsDialog->setForceManualRegion(forceManualRegionSetting);
+    settingsDialog->setTrackBoard(trackBoardSetting);
     settingsDialog->setAutoMoveWhenReady(ui->automoveCheck->isChecked());
     settingsDialog->setAutoMoveDelay(autoMoveDelayMs);
     settingsDialog->setStockfishPath(stockfishPath);
+    settingsDialog->setEngineBackend(engineKind);
     settingsDialog->setFenModelPath(fenModelPath);
     settingsDialog->setDefaultPlayerColor(ui->whiteRadioButton->isChecked() ? "White" : "Black");
+    settingsDialog->setRecordSessions(recordSessionSetting);
     if (settingsDialog->exec() == QDialog::Accepted) {
         analysisInterval = settingsDialog->analysisInterval();
         stockfishDepth = settingsDialog->stockfishDepth();
         ui->stealthCheck->setChecked(settingsDialog->stealthModeEnabled());
+        arrowLines = settingsDialog->arrowLines();
+        pvArrowPlies = settingsDialog->pvArrowPlies();
+        uiRefreshRate = settingsDialog->uiRefreshRate();
+        engineState->setRefreshRate(uiRefreshRate);
         useAutoBoardDetectionSetting = settingsDialog->useAutoBoardDetection();
         forceManualRegionSetting = settingsDialog->forceManualRegion();
+        trackBoardSetting = settingsDialog->trackBoard();
         ui->automoveCheck->setChecked(settingsDialog->autoMoveWhenReady());
         autoMoveDelayMs = settingsDialog->autoMoveDelay();
         stockfishPath = settingsDialog->stockfishPath();
+        engineKind = settingsDialog->engineBackend();
+        recordSessionSetting = settingsDialog->recordSessions();
+        if (!recordSessionSetting)
+            recorder.close();
+        bool modelChanged = fenModelPath != settingsDialog->fenModelPath();
         fenModelPath = settingsDialog->fenModelPath();
         if (settingsDialog->defaultPlayerColor() == "Black")
             ui->blackRadioButton->setChecked(true);
@@ -982,12 +1283,16 @@ void MainWindow::openSettings()
             screenshotTimer->stop();
             screenshotTimer->start(analysisInterval);
         }
-        if (stockfishProcess) {
-            restartStockfishOnCrash = false;
-            stockfishProcess->kill();
-            stockfishProcess->deleteLater();
-            stockfishProcess = nullptr;
-            startStockfish();
+        if (recorder.isOpen())
+            recorder.recordSessionInfo(getMyColor().at(0).toLatin1(), analysisInterval);
+        startEngine();
+        if (modelChanged && recognizerScript.isEmpty()) {
+            // The running server swaps models in the background and keeps
+            // answering frames meanwhile; only start one if there is none.
+            if (fenServer && fenServer->state() == QProcess::Running)
+                fenServer->write(QStringLiteral("[model] %1\n").arg(fenModelPath).toUtf8());
+            else
+                startFenServer();
         }
     }
 }
@@ -1001,25 +1306,28 @@ void MainWindow::on_resetGameButton_clicked()
         ui->toggleAnalysisButton->setText("Start Analysis (Ctrl +A)");
     }
 
-    lastFen.clear();
-    lastEvaluatedFen.clear();
-    lastPlayedFen.clear();
+    livePosition = PackedPosition();
+    evaluatedPosition = PackedPosition();
+    reviewing = false;
+    lastPlayedPosition = PackedPosition();
     lastOwnMove.clear();
-    boardTurnColor.clear();
-    repetitionTable.clear();
+    game.reset();
+    pgn.finishGame();
     multipvMoves.clear();
+    pvLines.clear();
+    engineState->reset();
     currentBestMove.clear();
     pendingEvalLine = -1;
     lastEvalForMe = 0.0;
     lastEvalValid = false;
-    moveHistoryLines.clear();
+    moveList->clear();
+    evalGraph->clear();
 
     if (board) {
-        board->setPositionFromFen("", getMyColor() == "b");
+        board->setPosition(PackedPosition(), getMyColor() == "b");
         board->setArrows({});
     }
 
-    ui->pgnDisplay->clear();
     ui->fenDisplay->setPlainText("Waiting for FEN...");
     ui->bestMoveDisplay->clear();
     evalScoreLabel->clear();
@@ -1041,7 +1349,7 @@ MainWindow::MoveChoice MainWindow::pickBestMove(bool stealth)
 
     QVector<MoveChoice> candidates;
     MoveChoice best;
-    best.move = first.first;
+    best.move = QString::fromLatin1(first.first);
     best.score = first.second;
     best.rank = 1;
     candidates.append(best);
@@ -1052,7 +1360,7 @@ MainWindow::MoveChoice MainWindow::pickBestMove(bool stealth)
                 auto pair = multipvMoves.value(i);
                 if (qAbs(baseScore - pair.second) < 30) {
                     MoveChoice alt;
-                    alt.move = pair.first;
+                    alt.move = QString::fromLatin1(pair.first);
                     alt.score = pair.second;
                     alt.rank = i;
                     candidates.append(alt);
@@ -4,6 +4,17 @@
 #include "chessboard_detector.h"
 #include "boardwidget.h"
 #include "settingsdialog.h"
+#include "boarddecoder.h"
+#include "recognizerprotocol.h"
+#include "enginebackend.h"
+#include "enginestatemodel.h"
+#include "movelistmodel.h"
+#include "evalgraphwidget.h"
+#include "boardtracker.h"
+#include "gametracker.h"
+#include "pgnwriter.h"
+#include "sessionrecorder.h"
+#include "screencapture.h"
 #include <QLabel>
 #include <QMainWindow>
 #include <QTimer>
@@ -26,11 +37,17 @@ QT_END_NAMESPACE
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
+    friend class LatencyBenchmark;
+    friend class SessionReplay;
 
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+signals:
+    // A frame's Result, Skip or Error, after the window has handled it.
+    void recognizerAnswered(const RecognizerMessage& msg);
+
 private slots:
     void on_setRegionButton_clicked();
     void on_toggleAnalysisButton_clicked();
@@ -40,11 +57,19 @@ private slots:
 private:
     Ui::MainWindow *ui;
     QRect captureRegion;
+    BoardTracker boardTracker;
+    bool trackBoardSetting = true;
+    // grid: the detected lattice of the board in region, if there is one.
+    void setCaptureRegion(const QRect& region, const BoardGeometry& grid = BoardGeometry());
+    BoardGeometry captureGrid;          // invalid for a manually selected region
+    bool recoverBoard();
+    void selectRegionManually();
     QTimer* screenshotTimer;
     bool analysisRunning = false;
     QProcess* pythonProcess = nullptr;
-    QProcess* stockfishProcess = nullptr;
-    QString lastFen;
+    EngineBackend* engine = nullptr;
+    int engineKind = EngineBackend::Stockfish;
+    PackedPosition livePosition;       // last recognized position, as tracked
     int analysisInterval = 1000;  // milliseconds
     int stockfishDepth = 15;
     int autoMoveDelayMs = 0;
@@ -53,25 +78,48 @@ private:
     bool forceManualRegionSetting = false;
     QString stockfishPath;
     QString fenModelPath;
+    QString serverModelPath;           // model the running recognizer uses
     QString getMyColor() const;
     void captureScreenshot();
-    void runFenPrediction(const QString& imagePath);
+    quint32 runFenPrediction(const QString& imagePath);
+    quint32 submitFrame(const QImage& image);
     QProcess* fenServer = nullptr;
     QString myColor = "w";
-    void startStockfish();
-    void evaluatePosition(const QString& fen);
+    void startEngine();
+    void handleEngineInfo(const EngineInfo& info);
+    void applyEngineSnapshot(const EngineSnapshot& snapshot);
+    EngineStateModel* engineState = nullptr;
+    int uiRefreshRate = 0;  // Hz, 0 = display refresh rate
+    void handleBestMove(const QString& bestMove);
+    void evaluatePosition(const PackedPosition& position);
     QRect autoDetectedRegion;
+    BoardGeometry autoDetectedGrid;
     QDialog* autoOverlay = nullptr;
     BoardWidget* board = nullptr;
+    EvalGraphWidget* evalGraph = nullptr;
     void setStatusLight(const QString& color);
     void updateStatusLabel(const QString& text);
+    enum SubsystemState { SubsystemStarting, SubsystemReady, SubsystemFailed };
+    void setSubsystemState(QLabel* label, const QString& name, SubsystemState state);
+    void reportFirstFen();
+    QLabel* recognizerStatus = nullptr;
+    QLabel* engineStatus = nullptr;
+    QLabel* firstFenLabel = nullptr;
     void startFenServer();
+    QString recognizerScript;          // empty = python/fen_tracker/main.py
+    QStringList recognizerArguments;   // extra arguments for the script
+    void readFenServerOutput();
+    void handleFenResult(const RecognizerMessage& msg);
+    RecognizerStreamParser recognizerParser;
+    RecognizerMessage recognizerMessage;
+    quint32 frameSequence = 0;
+    QMap<quint32, qint64> pendingFrames;  // sequence -> send time (ns)
+    QElapsedTimer pipelineClock;
     QLabel* evalScoreLabel = nullptr;
     QVariantAnimation* evalAnimation = nullptr;
     void setEvalBarValue(int value);
     int scaleEval(int cp) const;
     void updateEvalLabel();
-    QString boardTurnColor;   // "w" or "b"
 
     struct MoveChoice {
         QString move;
@@ -83,15 +131,23 @@ private:
     QString currentBestMove;
     void playBestMove();
     void playMove(const QString &uci);
-    void updateRepetitionTable(const QString &fen, bool afterMove = true);
     bool isMyTurn = false;
-    QString lastEvaluatedFen;
+    PackedPosition evaluatedPosition;
     QQueue<QString> recentBestMoves;
-    QString lastPlayedFen;
+    PackedPosition lastPlayedPosition;
     QString lastOwnMove;
-    QHash<QString, int> repetitionTable;
+    GameTracker game;                  // moves, repetitions, fifty-move clock
+    PgnWriter pgn{PgnWriter::defaultPath()};  // session games, appended per move
+    SessionRecorder recorder;          // opt-in log of frames and results for replay
+    bool recordSessionSetting = false;
+    bool replaying = false;            // frames come from a SessionReplay
     bool automoveInProgress = false;
-    QMap<int, QPair<QString, int>> multipvMoves;
+    QMap<int, QPair<QByteArray, int>> multipvMoves;  // multipv -> first move, score
+    QMap<int, QByteArray> pvLines;      // multipv -> principal variation, raw UCI moves
+    int arrowLines = 1;                 // MultiPV lines drawn as arrows
+    int pvArrowPlies = 0;               // plies of line 1 drawn after its first move
+    bool liveArrows() const { return arrowLines > 1 || pvArrowPlies > 0; }
+    void updateAnalysisArrows();
     int selectedBestMoveRank = 1;
     double accuracy = 0.9;
     QElapsedTimer screenshotElapsed;
@@ -99,16 +155,18 @@ private:
     QElapsedTimer evalElapsed;
     GlobalHotkeyManager* hotkeyManager = nullptr;
 
-    QStringList moveHistoryLines;
-    QString detectUciMove(const QString& prevFen, const QString& currFen) const;
-    int addMoveToHistory(const QString& moveUci, bool whiteMove);
+    MoveListModel* moveList = nullptr;
+    int addMoveToHistory(const QString& moveUci, bool whiteMove, const PackedPosition& after);
     void appendEvalChangeToHistory(int index, double delta);
+    void recordEvaluation(const EngineSnapshot& snapshot);
+    void jumpToMove(const QModelIndex& index);
+    void returnToLive();
+    bool reviewing = false;             // board shows a past move from the list
 
     double lastEvalForMe = 0.0;
     bool lastEvalValid = false;
     int pendingEvalLine = -1;
 
-    bool restartStockfishOnCrash = true;
     bool restartFenServerOnCrash = true;
 
 
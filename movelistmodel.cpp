@@ -0,0 +1,75 @@
+#include "movelistmodel.h"
+
+MoveListModel::MoveListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int MoveListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : entries.size();
+}
+
+QVariant MoveListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= entries.size())
+        return QVariant();
+
+    const Entry &e = entries.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole: {
+        QString text = QString::number(e.moveNumber) + (e.white ? ". " : "... ") + e.uci;
+        if (e.hasEval) {
+            QString sign = e.evalDelta >= 0 ? "+" : "";
+            text += QString(" (%1%2)").arg(sign).arg(QString::number(e.evalDelta, 'f', 2));
+        }
+        return text;
+    }
+    case UciRole:
+        return e.uci;
+    case FenRole:
+        return QString::fromStdString(e.position.fen());
+    case EvalDeltaRole:
+        return e.hasEval ? QVariant(double(e.evalDelta)) : QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+int MoveListModel::appendMove(const QString &uci, bool whiteMove, const PackedPosition &after) {
+    Entry e;
+    e.uci = uci;
+    e.position = after;
+    e.white = whiteMove;
+    if (!entries.isEmpty()) {
+        // Only Black's reply shares its predecessor's number; two moves in a
+        // row by White (a missed frame) still advance it.
+        const Entry &prev = entries.last();
+        e.moveNumber = (prev.white && !whiteMove) ? prev.moveNumber : prev.moveNumber + 1;
+    }
+
+    const int row = entries.size();
+    beginInsertRows(QModelIndex(), row, row);
+    entries.append(e);
+    endInsertRows();
+    return row;
+}
+
+void MoveListModel::setEvalDelta(int row, double delta) {
+    if (row < 0 || row >= entries.size())
+        return;
+    entries[row].hasEval = true;
+    entries[row].evalDelta = float(delta);
+    const QModelIndex idx = index(row);
+    emit dataChanged(idx, idx, {Qt::DisplayRole, EvalDeltaRole});
+}
+
+PackedPosition MoveListModel::positionAt(int row) const {
+    return (row >= 0 && row < entries.size()) ? entries.at(row).position : PackedPosition();
+}
+
+void MoveListModel::clear() {
+    if (entries.isEmpty())
+        return;
+    beginResetModel();
+    entries.clear();
+    endResetModel();
+}
@@ -0,0 +1,48 @@
+#ifndef MOVELISTMODEL_H
+#define MOVELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+#include "packedposition.h"
+
+// Session move history, one row per ply. Rows are only formatted when a view
+// asks for them, so appending stays O(1) and a uniform-height QListView
+// handles tens of thousands of plies.
+class MoveListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        UciRole = Qt::UserRole + 1,
+        FenRole,            // position after the move, formatted on request
+        EvalDeltaRole,      // pawns, invalid QVariant when not annotated
+    };
+
+    explicit MoveListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Returns the new row.
+    int appendMove(const QString &uci, bool whiteMove, const PackedPosition &after);
+    void setEvalDelta(int row, double delta);
+    // Empty (isEmpty()) for rows out of range.
+    PackedPosition positionAt(int row) const;
+    void clear();
+
+private:
+    struct Entry {
+        QString uci;
+        PackedPosition position;
+        int moveNumber = 1;
+        bool white = true;
+        bool hasEval = false;
+        float evalDelta = 0.0f;
+    };
+
+    QVector<Entry> entries;
+};
+
+#endif // MOVELISTMODEL_H
@@ -0,0 +1,49 @@
+#include "packedposition.h"
+#include "chessposition.h"
+
+std::string PackedPosition::placementFen() const {
+    std::string out;
+    out.reserve(72);
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            uint8_t piece = pieceAt(rank * 8 + file);
+            if (piece == ChessPosition::NoPiece) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                out += char('0' + empty);
+                empty = 0;
+            }
+            out += ChessPosition::pieceToChar(piece);
+        }
+        if (empty)
+            out += char('0' + empty);
+        if (rank > 0)
+            out += '/';
+    }
+    return out;
+}
+
+std::string PackedPosition::fen() const {
+    std::string out = placementFen();
+    out += side == ChessPosition::White ? " w " : " b ";
+    if (castling & ChessPosition::WhiteKingSide)  out += 'K';
+    if (castling & ChessPosition::WhiteQueenSide) out += 'Q';
+    if (castling & ChessPosition::BlackKingSide)  out += 'k';
+    if (castling & ChessPosition::BlackQueenSide) out += 'q';
+    if (!castling) out += '-';
+    out += ' ';
+    out += ChessPosition::squareName(epSquare);
+    out += ' ' + std::to_string(halfmove) + ' ' + std::to_string(fullmove);
+    return out;
+}
+
+bool PackedPosition::fromFen(const std::string &fen, PackedPosition &out) {
+    ChessPosition position;
+    if (!position.setFromFen(fen))
+        return false;
+    out = position.packed();
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef PACKEDPOSITION_H
+#define PACKEDPOSITION_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// A position as passed around inside the GUI: 40 bytes, no heap, copied
+// with memcpy and compared with memcmp. Squares hold ChessPosition piece
+// codes (0..12), two per byte, a1 in the low nibble of squares[0]. FEN text
+// is produced only where it leaves the process or is shown: the UCI engine,
+// the FEN box and the move list's FenRole.
+struct PackedPosition {
+    uint8_t squares[32] = {};
+    uint8_t side = 0;        // ChessPosition::Color
+    uint8_t castling = 0;    // ChessPosition::CastlingRight bits
+    uint8_t epSquare = 64;   // a1 = 0, 64 = none
+    uint8_t reserved = 0;    // keeps the layout free of padding
+    uint16_t halfmove = 0;
+    uint16_t fullmove = 1;
+
+    uint8_t pieceAt(int sq) const { return (squares[sq >> 1] >> ((sq & 1) << 2)) & 0xF; }
+    void setPiece(int sq, uint8_t piece) {
+        const int shift = (sq & 1) << 2;
+        squares[sq >> 1] = uint8_t((squares[sq >> 1] & ~(0xF << shift)) | (piece << shift));
+    }
+    // out[64], a1 first.
+    void unpack(uint8_t *out) const {
+        for (int i = 0; i < 32; ++i) {
+            out[2 * i] = squares[i] & 0xF;
+            out[2 * i + 1] = squares[i] >> 4;
+        }
+    }
+    void pack(const uint8_t *pieces) {
+        for (int i = 0; i < 32; ++i)
+            squares[i] = uint8_t(pieces[2 * i] | (pieces[2 * i + 1] << 4));
+    }
+
+    bool isEmpty() const {
+        static const uint8_t none[32] = {};
+        return std::memcmp(squares, none, sizeof(squares)) == 0;
+    }
+    bool samePlacement(const PackedPosition &o) const {
+        return std::memcmp(squares, o.squares, sizeof(squares)) == 0;
+    }
+    bool operator==(const PackedPosition &o) const {
+        return std::memcmp(this, &o, sizeof(PackedPosition)) == 0;
+    }
+    bool operator!=(const PackedPosition &o) const { return !(*this == o); }
+
+    std::string placementFen() const;
+    std::string fen() const;
+    // Validated like ChessPosition::setFromFen; out is left untouched on failure.
+    static bool fromFen(const std::string &fen, PackedPosition &out);
+};
+
+static_assert(std::is_trivially_copyable<PackedPosition>::value,
+              "PackedPosition must stay memcpy-able");
+static_assert(sizeof(PackedPosition) == 40, "PackedPosition layout changed");
+
+#endif // PACKEDPOSITION_H
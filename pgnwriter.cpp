@@ -0,0 +1,155 @@
+#include "pgnwriter.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+namespace {
+
+// Export format keeps movetext lines under 80 characters.
+const int MaxLineLength = 79;
+
+} // namespace
+
+PgnWriter::PgnWriter(const QString &path)
+    : file(path)
+{
+}
+
+PgnWriter::~PgnWriter() {
+    finishGame();
+}
+
+QString PgnWriter::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        + "/games/session-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".pgn";
+}
+
+void PgnWriter::beginGame(const ChessPosition &start, const QString &comment) {
+    finishGame(comment);
+    startFrom(start);
+}
+
+void PgnWriter::startFrom(const ChessPosition &start) {
+    const std::string fen = start.fen();
+    startFen = fen == ChessPosition::startFen() ? QString() : QString::fromStdString(fen);
+    lastPosition = start.packed();
+    haveStart = true;
+}
+
+void PgnWriter::addMove(const std::string &san, const ChessPosition &after) {
+    if (!haveStart || san.empty())
+        return;
+
+    const bool whiteMoved = after.sideToMove() == ChessPosition::Black;
+    if (movesWritten + hasPending > 0 && whiteMoved == pendingWhite) {
+        // The same side twice (the tracker corrected its side to move): the
+        // movetext can't express that, so continue in a new game from the
+        // position before this move.
+        ChessPosition before;
+        PackedPosition p = lastPosition;
+        p.side = whiteMoved ? ChessPosition::White : ChessPosition::Black;
+        p.epSquare = ChessPosition::NoSquare;
+        before.setFromPacked(p);
+        finishGame("Move order lost, continued in the next game");
+        startFrom(before);
+    } else if (hasPending) {
+        writePending(QString());
+    }
+
+    pendingSan = QString::fromStdString(san);
+    pendingWhite = whiteMoved;
+    pendingNumber = whiteMoved ? after.fullmoveNumber() : after.fullmoveNumber() - 1;
+    hasPending = true;
+    lastPosition = after.packed();
+}
+
+void PgnWriter::annotateLastMove(int whiteScore, bool isMate) {
+    if (!hasPending)
+        return;
+    const QString eval = isMate ? QString("#%1").arg(whiteScore)
+                                : QString::number(whiteScore / 100.0, 'f', 2);
+    writePending(QString("[%eval %1]").arg(eval));
+}
+
+void PgnWriter::finishGame(const QString &comment) {
+    if (hasPending)
+        writePending(QString());
+    if (gameOpen) {
+        QByteArray out;
+        if (!comment.isEmpty())
+            writeToken(out, "{" + comment + "}");
+        writeToken(out, "*");
+        out += "\n\n";
+        write(out);
+        gameOpen = false;
+    }
+    haveStart = false;
+    movesWritten = 0;
+}
+
+void PgnWriter::writePending(const QString &comment) {
+    hasPending = false;
+
+    QByteArray out;
+    if (!gameOpen)
+        writeHeaders(out);
+    if (pendingWhite)
+        writeToken(out, QString::number(pendingNumber) + ".");
+    else if (movesWritten == 0 || afterComment)
+        writeToken(out, QString::number(pendingNumber) + "...");
+    writeToken(out, pendingSan);
+    afterComment = !comment.isEmpty();
+    if (afterComment)
+        writeToken(out, "{" + comment + "}");
+    ++movesWritten;
+    write(out);
+}
+
+void PgnWriter::writeHeaders(QByteArray &out) {
+    ++round;
+    out += "[Event \"FENgineLive session\"]\n";
+    out += "[Site \"?\"]\n";
+    out += "[Date \"" + QDate::currentDate().toString("yyyy.MM.dd").toLatin1() + "\"]\n";
+    out += "[Round \"" + QByteArray::number(round) + "\"]\n";
+    out += "[White \"?\"]\n";
+    out += "[Black \"?\"]\n";
+    out += "[Result \"*\"]\n";
+    if (!startFen.isEmpty()) {
+        out += "[SetUp \"1\"]\n";
+        out += "[FEN \"" + startFen.toLatin1() + "\"]\n";
+    }
+    out += "\n";
+    gameOpen = true;
+    afterComment = false;
+    lineLength = 0;
+}
+
+void PgnWriter::writeToken(QByteArray &out, const QString &token) {
+    if (lineLength > 0) {
+        if (lineLength + 1 + token.size() > MaxLineLength) {
+            out += '\n';
+            lineLength = 0;
+        } else {
+            out += ' ';
+            ++lineLength;
+        }
+    }
+    out += token.toUtf8();
+    lineLength += token.size();
+}
+
+bool PgnWriter::write(const QByteArray &data) {
+    if (!file.isOpen()) {
+        QDir().mkpath(QFileInfo(file).absolutePath());
+        if (!file.open(QFile::WriteOnly | QFile::Append)) {
+            qWarning() << "[pgn] Cannot write" << file.fileName() << file.errorString();
+            return false;
+        }
+        qDebug() << "[pgn] Recording games to" << file.fileName();
+    }
+    // Flushed per move so a crash loses nothing already written.
+    return file.write(data) == data.size() && file.flush();
+}
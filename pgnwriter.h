@@ -0,0 +1,61 @@
+#ifndef PGNWRITER_H
+#define PGNWRITER_H
+
+#include "chessposition.h"
+#include <QFile>
+#include <QString>
+
+// Appends the games of a session to one PGN file as they are played. Each
+// confirmed move is written in SAN and flushed as soon as its [%eval]
+// annotation arrives, or when the next move does, so a crash loses at most
+// the move still being analysed. Nothing but that one move is kept in
+// memory, however long the session.
+//
+// Headers are written with the first move, so positions that never get a
+// move (start-up, a board that lost track) leave no empty games. The result
+// of a watched game is rarely visible on the board; games end with "*" and,
+// for mate or stalemate, a comment saying so.
+class PgnWriter
+{
+public:
+    // The file is created on the first move.
+    explicit PgnWriter(const QString &path);
+    ~PgnWriter();
+
+    static QString defaultPath();
+    QString fileName() const { return file.fileName(); }
+
+    // Finishes the game in progress, if any, and starts one from start.
+    void beginGame(const ChessPosition &start, const QString &comment = QString());
+    // san: the move that led to after.
+    void addMove(const std::string &san, const ChessPosition &after);
+    // Engine score of the position after the last move, from White's side:
+    // centipawns, or moves to mate when isMate.
+    void annotateLastMove(int whiteScore, bool isMate);
+    // comment ends up before the "*" termination marker.
+    void finishGame(const QString &comment = QString());
+
+private:
+    QFile file;
+    bool haveStart = false;
+    QString startFen;          // empty: standard start position
+    PackedPosition lastPosition;  // after the last move added
+    int round = 0;
+    int movesWritten = 0;
+    bool gameOpen = false;     // headers written, no termination marker yet
+    bool afterComment = false; // Black's next move then needs its "N..."
+    int lineLength = 0;
+
+    bool hasPending = false;
+    QString pendingSan;
+    int pendingNumber = 1;
+    bool pendingWhite = true;
+
+    void startFrom(const ChessPosition &start);
+    void writePending(const QString &comment);
+    void writeHeaders(QByteArray &out);
+    void writeToken(QByteArray &out, const QString &token);
+    bool write(const QByteArray &data);
+};
+
+#endif // PGNWRITER_H
@@ -0,0 +1,118 @@
+#include "piecespritecache.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QPainter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QSvgRenderer>
+#include <cmath>
+
+namespace {
+// SVG base names in atlas order, matching ChessPosition::Piece 1..12.
+const char *const kPieceFiles[12] = {"wP", "wN", "wB", "wR", "wQ", "wK",
+                                     "bP", "bN", "bB", "bR", "bQ", "bK"};
+
+QImage renderAtlas(const QString &svgDir, int pixelSize) {
+    QImage atlas(pixelSize * 12, pixelSize, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+    QPainter painter(&atlas);
+    for (int i = 0; i < 12; ++i) {
+        QSvgRenderer renderer(QString("%1/%2.svg").arg(svgDir, kPieceFiles[i]));
+        renderer.render(&painter, QRectF(i * pixelSize, 0, pixelSize, pixelSize));
+    }
+    return atlas;
+}
+}
+
+PieceSpriteCache::PieceSpriteCache(const QString &set, QObject *parent)
+    : QObject(parent), pieceSet(set.isEmpty() ? QStringLiteral("default") : set)
+{
+    // Prefer the copy next to the executable so the working directory
+    // doesn't matter; fall back to the old relative path.
+    QString base = QCoreApplication::applicationDirPath() + "/assets/pieces";
+    if (!QDir(base).exists())
+        base = QStringLiteral("assets/pieces");
+    svgDir = set.isEmpty() ? base : base + "/" + set;
+
+    // The SVG fingerprint is taken by the first atlas job, off the GUI
+    // thread, so constructing the cache costs no file I/O at startup.
+    cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pieces";
+    QDir().mkpath(cacheDir);
+
+    memory.setMaxCost(8);
+    pool.setMaxThreadCount(1);
+}
+
+PieceSpriteCache::~PieceSpriteCache() {
+    // Queued results reference this object; let the worker drain first.
+    pool.clear();
+    pool.waitForDone();
+}
+
+QString PieceSpriteCache::diskPath(int pixelSize) {
+    if (fingerprint.isEmpty()) {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        for (const char *name : kPieceFiles) {
+            QFile svg(QString("%1/%2.svg").arg(svgDir, name));
+            if (svg.open(QIODevice::ReadOnly))
+                hash.addData(svg.readAll());
+        }
+        fingerprint = QString::fromLatin1(hash.result().toHex().left(12));
+    }
+    return QString("%1/%2-%3-%4.png").arg(cacheDir, pieceSet, fingerprint).arg(pixelSize);
+}
+
+bool PieceSpriteCache::sprites(int size, qreal dpr, QPixmap out[13]) {
+    if (size <= 0)
+        return false;
+
+    const QString key = QString("%1@%2").arg(size).arg(dpr);
+    if (SpriteSet *set = memory.object(key)) {
+        for (int piece = 1; piece < 13; ++piece)
+            out[piece] = set->pixmaps[piece];
+        return true;
+    }
+    if (pending.contains(key))
+        return false;
+    // While a window is being resized only the latest size matters; drop
+    // queued sizes that haven't started yet.
+    pool.clear();
+    pending.clear();
+    pending.insert(key);
+
+    const int pixelSize = qMax(1, int(std::lround(size * dpr)));
+    const QString dir = svgDir;
+    pool.start([this, key, size, dpr, pixelSize, dir]() {
+        const QString path = diskPath(pixelSize);  // pool thread only
+        QImage atlas;
+        if (!atlas.load(path) || atlas.width() != pixelSize * 12 || atlas.height() != pixelSize) {
+            atlas = renderAtlas(dir, pixelSize);
+            QSaveFile file(path);
+            if (file.open(QIODevice::WriteOnly) && atlas.save(&file, "PNG"))
+                file.commit();
+            else
+                qDebug() << "[sprites] Could not write" << path;
+        }
+        QMetaObject::invokeMethod(this, [this, key, atlas, size, dpr]() {
+            atlasFinished(key, atlas, size, dpr);
+        }, Qt::QueuedConnection);
+    });
+    return false;
+}
+
+void PieceSpriteCache::atlasFinished(const QString &key, const QImage &atlas, int size, qreal dpr) {
+    pending.remove(key);
+
+    const int pixelSize = atlas.height();
+    SpriteSet *set = new SpriteSet;
+    for (int i = 0; i < 12; ++i) {
+        QPixmap pix = QPixmap::fromImage(atlas.copy(i * pixelSize, 0, pixelSize, pixelSize));
+        pix.setDevicePixelRatio(dpr);
+        set->pixmaps[i + 1] = pix;
+    }
+    memory.insert(key, set);
+    emit spritesReady(size, dpr);
+}
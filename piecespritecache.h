@@ -0,0 +1,51 @@
+#ifndef PIECESPRITECACHE_H
+#define PIECESPRITECACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+// Rasterized piece sprites keyed by (size, devicePixelRatio, piece set).
+//
+// SVGs are rendered into a one-row atlas on a worker thread and the atlas is
+// written to the cache directory, so repeat sizes and later launches load a
+// PNG instead of parsing SVG. Callers ask with sprites(); on a miss the atlas
+// is scheduled and spritesReady() fires once it can be served.
+class PieceSpriteCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // pieceSet names a subdirectory of assets/pieces; empty = the default set.
+    explicit PieceSpriteCache(const QString &pieceSet = QString(), QObject *parent = nullptr);
+    ~PieceSpriteCache() override;
+
+    // Fills out[1..12] (indexed by ChessPosition::Piece) and returns true if
+    // sprites for this size are available; otherwise queues them.
+    bool sprites(int size, qreal dpr, QPixmap out[13]);
+
+signals:
+    void spritesReady(int size, qreal dpr);
+
+private:
+    struct SpriteSet {
+        QPixmap pixmaps[13];
+    };
+
+    void atlasFinished(const QString &key, const QImage &atlas, int size, qreal dpr);
+    QString diskPath(int pixelSize);  // worker only: fills in fingerprint
+
+    QString pieceSet;
+    QString svgDir;
+    QString cacheDir;
+    QString fingerprint;  // changes whenever an SVG does; set by the worker
+    QCache<QString, SpriteSet> memory;
+    QSet<QString> pending;
+    QThreadPool pool;
+};
+
+#endif // PIECESPRITECACHE_H
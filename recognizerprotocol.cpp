@@ -0,0 +1,126 @@
+#include "recognizerprotocol.h"
+#include "chessposition.h"
+
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+const char Magic[4] = { 'F', 'E', 'N', 'R' };
+
+// Refuse absurd lengths instead of waiting forever for a corrupt frame.
+const quint32 MaxPayloadSize = 64 * 1024;
+
+} // namespace
+
+PackedPosition RecognizerMessage::position() const {
+    // grid is in capture orientation; when the capture is from Black's side
+    // the board is rotated 180 degrees.
+    PackedPosition p;
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            int sq = flipped() ? row * 8 + (7 - col) : (7 - row) * 8 + col;
+            quint8 cls = grid[row * 8 + col];
+            p.setPiece(sq, cls <= ChessPosition::BKing ? cls : ChessPosition::NoPiece);
+        }
+    }
+    p.side = sideToMove == 'b' ? ChessPosition::Black : ChessPosition::White;
+    p.castling = castling & 0x0F;
+    p.epSquare = epSquare < 64 ? epSquare : 64;
+    return p;
+}
+
+QString RecognizerMessage::fen() const {
+    return QString::fromStdString(position().fen());
+}
+
+void RecognizerStreamParser::append(const QByteArray &data) {
+    // Compact lazily so a burst of small messages doesn't memmove each time.
+    if (readPos > 0 && readPos >= buffer.size() / 2) {
+        buffer.remove(0, readPos);
+        readPos = 0;
+    }
+    buffer.append(data);
+}
+
+void RecognizerStreamParser::reset() {
+    buffer.clear();
+    readPos = 0;
+}
+
+bool RecognizerStreamParser::resync() {
+    // Skip to the next magic; keep a possible partial magic at the end.
+    int idx = buffer.indexOf(QByteArray::fromRawData(Magic, 4), readPos);
+    if (idx < 0) {
+        readPos = qMax(readPos, int(buffer.size()) - 3);
+        return false;
+    }
+    readPos = idx;
+    return true;
+}
+
+bool RecognizerStreamParser::next(RecognizerMessage &msg) {
+    for (;;) {
+        const int available = int(buffer.size()) - readPos;
+        if (available < RecognizerMessage::HeaderSize)
+            return false;
+
+        const uchar *p = reinterpret_cast<const uchar *>(buffer.constData()) + readPos;
+        if (std::memcmp(p, Magic, 4) != 0) {
+            ++readPos;
+            if (!resync())
+                return false;
+            continue;
+        }
+
+        const quint32 length = qFromLittleEndian<quint32>(p + 4);
+        if (length < RecognizerMessage::FixedPayloadSize || length > MaxPayloadSize) {
+            ++readPos;
+            if (!resync())
+                return false;
+            continue;
+        }
+        if (available < RecognizerMessage::HeaderSize + int(length))
+            return false;
+
+        const uchar *payload = p + RecognizerMessage::HeaderSize;
+        const uchar *end = payload + length;
+        readPos += RecognizerMessage::HeaderSize + int(length);
+
+        if (payload[0] != RecognizerMessage::Version)
+            continue;
+
+        msg.type = payload[1];
+        msg.flags = qFromLittleEndian<quint16>(payload + 2);
+        msg.sequence = qFromLittleEndian<quint32>(payload + 4);
+        msg.serverMicros = qFromLittleEndian<quint32>(payload + 8);
+        msg.inferenceMicros = qFromLittleEndian<quint32>(payload + 12);
+        std::memcpy(msg.grid, payload + 16, 64);
+        msg.sideToMove = char(payload[80]);
+        msg.castling = payload[81];
+        msg.epSquare = payload[82];
+        msg.skipReason = payload[83];
+
+        const uchar *cursor = payload + RecognizerMessage::FixedPayloadSize;
+        msg.changedSquares = 0;
+        if (msg.hasChangedSquares()) {
+            if (end - cursor < 8)
+                continue;
+            msg.changedSquares = qFromLittleEndian<quint64>(cursor);
+            cursor += 8;
+        }
+        if (msg.hasProbabilities()) {
+            if (end - cursor < RecognizerMessage::ProbabilitiesSize)
+                continue;
+            std::memcpy(msg.probabilities, cursor, RecognizerMessage::ProbabilitiesSize);
+            cursor += RecognizerMessage::ProbabilitiesSize;
+        }
+
+        if (msg.type == RecognizerMessage::Error || msg.type == RecognizerMessage::ModelSwapped
+            || msg.type == RecognizerMessage::ModelRejected)
+            msg.text = QByteArray(reinterpret_cast<const char *>(cursor), int(end - cursor));
+        else
+            msg.text.clear();
+        return true;
+    }
+}
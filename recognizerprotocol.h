@@ -0,0 +1,86 @@
+#ifndef RECOGNIZERPROTOCOL_H
+#define RECOGNIZERPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include "packedposition.h"
+
+// Binary result channel of the Python recognizer (fen_tracker/main.py).
+// Every message on its stdout is framed as
+//
+//   "FENR" | quint32 payload length | payload
+//
+// with a little-endian payload of
+//
+//   quint8  version, quint8 type, quint16 flags,
+//   quint32 frame sequence, quint32 server micros, quint32 inference micros,
+//   quint8  grid[64]            class per cell, image orientation, row 0 = top
+//   char    side to move        'w' / 'b'
+//   quint8  castling            ChessPosition::CastlingRight bits
+//   quint8  en passant square   a1 = 0, 64 = none
+//   quint8  skip reason
+//   quint64 changed squares          only with HasChangedSquares; bit
+//                                    row * 8 + col, image orientation
+//   quint8  probabilities[64 * 13]   only with HasProbabilities
+//   ...     UTF-8 text               Error: the error, ModelSwapped: the
+//                                    model path, ModelRejected: the reason
+//
+// Debug text goes to the process' stderr. Keep in sync with utils/protocol.py.
+struct RecognizerMessage {
+    enum Type : quint8 {
+        Ready = 0, Result = 1, Skip = 2, Error = 3,
+        ModelSwapped = 4, ModelRejected = 5  // answers to a "[model] <path>" command
+    };
+    enum Flag : quint16 { HasProbabilities = 1, Flipped = 2, HasChangedSquares = 4 };
+    enum SkipReason : quint8 { NoReason = 0, NotStable = 1, Unchanged = 2 };
+
+    // 2: changed squares before the probabilities, ModelSwapped/Rejected.
+    // Messages of any other version are skipped.
+    static constexpr quint8 Version = 2;
+    static constexpr int HeaderSize = 8;
+    static constexpr int FixedPayloadSize = 16 + 64 + 4;
+    static constexpr int ProbabilitiesSize = 64 * 13;
+
+    quint8 type = Ready;
+    quint16 flags = 0;
+    quint32 sequence = 0;
+    quint32 serverMicros = 0;     // Ready: the server's own startup time
+    quint32 inferenceMicros = 0;
+    quint8 grid[64] = {};
+    char sideToMove = 'w';
+    quint8 castling = 0;
+    quint8 epSquare = 64;
+    quint8 skipReason = NoReason;
+    quint64 changedSquares = 0;  // squares that differ from the previous frame
+    quint8 probabilities[ProbabilitiesSize] = {};
+    QByteArray text;
+
+    bool hasProbabilities() const { return flags & HasProbabilities; }
+    bool flipped() const { return flags & Flipped; }
+    bool hasChangedSquares() const { return flags & HasChangedSquares; }
+
+    // The recognized position in true board orientation, unvalidated
+    // (counters are always "0 1"). fen() formats it for logs.
+    PackedPosition position() const;
+    QString fen() const;
+};
+
+// Incremental parser for the recognizer's stdout. Feed it whatever
+// readyRead delivered; complete messages are decoded into a caller-owned
+// RecognizerMessage so steady-state parsing does not allocate.
+class RecognizerStreamParser
+{
+public:
+    void append(const QByteArray &data);
+    bool next(RecognizerMessage &msg);
+    void reset();
+
+private:
+    QByteArray buffer;
+    int readPos = 0;
+
+    bool resync();
+};
+
+#endif // RECOGNIZERPROTOCOL_H
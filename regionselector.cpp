@@ -3,17 +3,19 @@
 #include <QScreen>
 #include <QGuiApplication>
 
-RegionSelector::RegionSelector(QWidget* parent) : QWidget(parent) {
+RegionSelector::RegionSelector(QScreen* screen, QWidget* parent) : QWidget(parent) {
     setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool);
     setAttribute(Qt::WA_TranslucentBackground);
     setAttribute(Qt::WA_NoSystemBackground);
     setAttribute(Qt::WA_TransparentForMouseEvents, false);
+    setAttribute(Qt::WA_DeleteOnClose);
 
     setCursor(Qt::CrossCursor);
 
     // Set size to full screen
-    QRect screenGeometry = QGuiApplication::primaryScreen()->geometry();
-    setGeometry(screenGeometry);
+    if (!screen)
+        screen = QGuiApplication::primaryScreen();
+    setGeometry(screen->geometry());
 }
 
 
@@ -34,7 +36,7 @@ void RegionSelector::mouseMoveEvent(QMouseEvent* event) {
 
 void RegionSelector::mouseReleaseEvent(QMouseEvent*) {
     selecting = false;
-    emit regionSelected(selection);
+    emit regionSelected(selectedRegion());
     close();
 }
 
@@ -57,5 +59,5 @@ void RegionSelector::paintEvent(QPaintEvent*) {
 
 
 QRect RegionSelector::selectedRegion() const {
-    return selection;
+    return selection.translated(geometry().topLeft());
 }
@@ -5,14 +5,18 @@
 #include <QMouseEvent>
 #include <QPainter>
 
+class QScreen;
+
 class RegionSelector : public QWidget {
     Q_OBJECT
 
 public:
-    explicit RegionSelector(QWidget* parent = nullptr);
+    // Covers one screen; nullptr means the primary screen.
+    explicit RegionSelector(QScreen* screen = nullptr, QWidget* parent = nullptr);
     QRect selectedRegion() const;
 
 signals:
+    // Global logical coordinates.
     void regionSelected(const QRect& region);
 
 protected:
@@ -0,0 +1,142 @@
+#include "screencapture.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QScreen>
+#include <QSemaphore>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+QScreen* screenForRegion(const QRect& region) {
+    QScreen* best = nullptr;
+    qint64 bestArea = 0;
+    for (QScreen* screen : QGuiApplication::screens()) {
+        QRect overlap = screen->geometry().intersected(region);
+        qint64 area = qint64(overlap.width()) * overlap.height();
+        if (area > bestArea) {
+            bestArea = area;
+            best = screen;
+        }
+    }
+    return best ? best : QGuiApplication::primaryScreen();
+}
+
+QPixmap grabScreenRegion(const QRect& region) {
+    QScreen* screen = screenForRegion(region);
+    if (!screen)
+        return QPixmap();
+
+    // With window 0, grabWindow() takes coordinates relative to the screen.
+    QPoint local = region.topLeft() - screen->geometry().topLeft();
+    return screen->grabWindow(0, local.x(), local.y(), region.width(), region.height());
+}
+
+QImage resampleBoardSquares(const QImage& capture, const QRect& region,
+                            const BoardGeometry& grid, int squareSize) {
+    QImage out(8 * squareSize, 8 * squareSize, QImage::Format_RGB32);
+    if (capture.isNull() || region.isEmpty()) {
+        out.fill(Qt::black);
+        return out;
+    }
+
+    // Logical to capture pixels.
+    const double sx = double(capture.width()) / region.width();
+    const double sy = double(capture.height()) / region.height();
+
+    QPainter painter(&out);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            QRectF square = grid.squareRect(row, col).translated(-QPointF(region.topLeft()));
+            QRectF source(square.x() * sx, square.y() * sy, square.width() * sx, square.height() * sy);
+            painter.drawImage(QRectF(col * squareSize, row * squareSize, squareSize, squareSize),
+                              capture, source);
+        }
+    }
+    return out;
+}
+
+QRect ScreenBoard::region() const {
+    QRectF outer = geometry.outerRect();
+    return QRect(qRound(outer.x()), qRound(outer.y()), qRound(outer.width()), qRound(outer.height()));
+}
+
+namespace {
+
+// Shared with the worker, which may outlive a timed-out call.
+struct ScreenJob {
+    QImage image;
+    BoardGeometry geometry;
+    std::atomic<bool> done{false};
+};
+
+} // namespace
+
+QVector<ScreenBoard> detectBoardsOnAllScreens(const QRect& exclude, int timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+
+    // Grabbing has to happen on the GUI thread; only detection is parallel.
+    const QList<QScreen*> screens = QGuiApplication::screens();
+    QVector<std::shared_ptr<ScreenJob>> jobs;
+    auto semaphore = std::make_shared<QSemaphore>();
+    for (QScreen* screen : screens) {
+        auto job = std::make_shared<ScreenJob>();
+        job->image = screen->grabWindow(0).toImage();
+
+        // The image keeps the screen's devicePixelRatio, so QPainter takes
+        // logical coordinates here.
+        QRect own = exclude.intersected(screen->geometry());
+        if (!own.isEmpty()) {
+            QPainter maskPainter(&job->image);
+            maskPainter.fillRect(own.translated(-screen->geometry().topLeft()), Qt::black);
+        }
+        jobs.append(job);
+
+        QThread* worker = QThread::create([job, semaphore]() {
+            job->geometry = detectBoardGeometry(job->image);
+            job->done = true;
+            semaphore->release();
+        });
+        QObject::connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+        worker->start();
+    }
+    qint64 grabMs = timer.elapsed();
+
+    for (int finished = 0; finished < jobs.size(); ++finished) {
+        int remaining = int(timeoutMs - timer.elapsed());
+        if (remaining <= 0 || !semaphore->tryAcquire(1, remaining)) {
+            qDebug() << "[detectChessboard]" << jobs.size() - finished
+                     << "screen(s) timed out after" << timeoutMs << "ms";
+            break;
+        }
+    }
+
+    QVector<ScreenBoard> boards;
+    for (int i = 0; i < jobs.size(); ++i) {
+        if (!jobs[i]->done || !jobs[i]->geometry.isValid())
+            continue;
+        ScreenBoard board;
+        board.screen = screens[i];
+        board.geometry = jobs[i]->geometry;
+        QPoint origin = screens[i]->geometry().topLeft();
+        for (int k = 0; k <= 8; ++k) {
+            board.geometry.files[k] += origin.x();
+            board.geometry.ranks[k] += origin.y();
+        }
+        boards.append(board);
+    }
+    std::sort(boards.begin(), boards.end(), [](const ScreenBoard& a, const ScreenBoard& b) {
+        return a.geometry.score > b.geometry.score;
+    });
+
+    qDebug() << "[detectChessboard]" << boards.size() << "board(s) on" << screens.size()
+             << "screen(s): grab" << grabMs << "ms, total" << timer.elapsed() << "ms";
+    for (const ScreenBoard& board : boards)
+        qDebug() << "   " << board.screen->name() << board.region() << "score" << board.geometry.score;
+    return boards;
+}
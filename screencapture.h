@@ -0,0 +1,38 @@
+#pragma once
+#include "chessboard_detector.h"
+#include <QPixmap>
+#include <QRect>
+#include <QVector>
+
+class QScreen;
+
+// All rects here are in global logical coordinates, the space captureRegion
+// lives in. Each screen has its own origin and devicePixelRatio.
+
+// Screen holding the larger part of region, or the primary screen if region
+// lies on none of them.
+QScreen* screenForRegion(const QRect& region);
+
+// Captures region from the screen that holds it, at that screen's
+// devicePixelRatio.
+QPixmap grabScreenRegion(const QRect& region);
+
+// Resamples capture, a grab of region at any devicePixelRatio, onto an
+// exact 8x8 grid of squareSize px squares: each output square is the
+// detected square of grid (global logical coordinates), so uneven square
+// sizes and sub-pixel board edges don't smear pieces across squares.
+QImage resampleBoardSquares(const QImage& capture, const QRect& region,
+                            const BoardGeometry& grid, int squareSize = 32);
+
+struct ScreenBoard {
+    QScreen* screen = nullptr;
+    BoardGeometry geometry;   // global logical coordinates
+
+    QRect region() const;
+};
+
+// Grabs every screen, blacks out `exclude` (our own window) and runs
+// detectBoardGeometry() on each screen in its own worker thread. Boards come
+// back best lattice score first; screens still running after timeoutMs are
+// left out.
+QVector<ScreenBoard> detectBoardsOnAllScreens(const QRect& exclude, int timeoutMs = 2500);
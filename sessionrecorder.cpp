@@ -0,0 +1,157 @@
+#include "sessionrecorder.h"
+#include "enginestatemodel.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// A frame PNG is well under this; anything larger is a corrupt length.
+const quint32 MaxChunkSize = 16 * 1024 * 1024;
+
+template <typename T>
+void append(QByteArray &out, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out.append(bytes, int(sizeof(T)));
+}
+
+} // namespace
+
+QString SessionRecorder::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        + "/recordings/session-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".fgsl";
+}
+
+bool SessionRecorder::open(const QString &path, char myColor, int analysisIntervalMs) {
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    file.setFileName(path);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "[recorder] Cannot write" << path << file.errorString();
+        return false;
+    }
+    clock.start();
+
+    QByteArray header(Magic, 4);
+    append<quint16>(header, Version);
+    file.write(header);
+
+    recordSessionInfo(myColor, analysisIntervalMs);
+    qDebug() << "[recorder] Recording session to" << path;
+    return true;
+}
+
+void SessionRecorder::close() {
+    if (file.isOpen())
+        file.close();
+}
+
+void SessionRecorder::recordSessionInfo(char myColor, int analysisIntervalMs) {
+    QByteArray info;
+    info.append(myColor);
+    append<quint32>(info, quint32(analysisIntervalMs));
+    writeChunk(SessionInfo, info);
+}
+
+void SessionRecorder::recordFrame(quint32 sequence, const QByteArray &png) {
+    QByteArray payload;
+    payload.reserve(4 + png.size());
+    append<quint32>(payload, sequence);
+    payload.append(png);
+    writeChunk(Frame, payload);
+}
+
+void SessionRecorder::recordRecognizerOutput(const QByteArray &data) {
+    writeChunk(RecognizerOutput, data);
+}
+
+void SessionRecorder::recordEngineResult(const PackedPosition &position, const QString &bestMove,
+                                         const EngineSnapshot &snapshot) {
+    QByteArray payload(reinterpret_cast<const char *>(&position), int(sizeof(PackedPosition)));
+    payload.append(char(snapshot.isMate ? 1 : 0));
+    append<qint32>(payload, snapshot.hasScore ? snapshot.whiteScore : 0);
+    append<quint16>(payload, quint16(snapshot.depth));
+    payload.append(bestMove.toUtf8());
+    writeChunk(EngineResult, payload);
+}
+
+void SessionRecorder::writeChunk(ChunkType type, const QByteArray &payload) {
+    if (!file.isOpen())
+        return;
+    QByteArray header;
+    header.reserve(ChunkHeaderSize);
+    header.append(char(type));
+    append<quint32>(header, quint32(payload.size()));
+    append<qint64>(header, clock.nsecsElapsed());
+    file.write(header);
+    file.write(payload);
+    file.flush();
+}
+
+bool SessionLogReader::open(const QString &path, QString *error) {
+    file.setFileName(path);
+    cutShort = false;
+    if (!file.open(QFile::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    const QByteArray header = file.read(SessionRecorder::FileHeaderSize);
+    if (header.size() != SessionRecorder::FileHeaderSize
+        || std::memcmp(header.constData(), SessionRecorder::Magic, 4) != 0) {
+        if (error)
+            *error = QStringLiteral("not a session log");
+        return false;
+    }
+    if (qFromLittleEndian<quint16>(header.constData() + 4) != SessionRecorder::Version) {
+        if (error)
+            *error = QStringLiteral("unsupported session log version");
+        return false;
+    }
+    return true;
+}
+
+bool SessionLogReader::next(Chunk &chunk) {
+    const QByteArray header = file.read(SessionRecorder::ChunkHeaderSize);
+    if (header.isEmpty())
+        return false;
+    if (header.size() != SessionRecorder::ChunkHeaderSize) {
+        cutShort = true;
+        return false;
+    }
+    const quint32 length = qFromLittleEndian<quint32>(header.constData() + 1);
+    if (length > MaxChunkSize) {
+        cutShort = true;
+        return false;
+    }
+    chunk.type = quint8(header.at(0));
+    chunk.timestampNs = qFromLittleEndian<qint64>(header.constData() + 5);
+    chunk.payload = file.read(length);
+    if (chunk.payload.size() != int(length)) {
+        cutShort = true;
+        return false;
+    }
+    return true;
+}
+
+bool SessionLogReader::decodeSessionInfo(const Chunk &chunk, char &myColor, int &analysisIntervalMs) {
+    if (chunk.type != SessionRecorder::SessionInfo || chunk.payload.size() < 5)
+        return false;
+    myColor = chunk.payload.at(0);
+    analysisIntervalMs = int(qFromLittleEndian<quint32>(chunk.payload.constData() + 1));
+    return true;
+}
+
+bool SessionLogReader::decodeFrame(const Chunk &chunk, quint32 &sequence, QByteArray &png) {
+    if (chunk.type != SessionRecorder::Frame || chunk.payload.size() < 4)
+        return false;
+    sequence = qFromLittleEndian<quint32>(chunk.payload.constData());
+    png = chunk.payload.mid(4);
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include "packedposition.h"
+
+struct EngineSnapshot;
+
+// Session log for reproducing recognition and latency problems: the frames
+// sent to the recognizer, its raw output and the engine's final results, in
+// the order they happened. The file is
+//
+//   "FGSL" | quint16 version | chunk...
+//
+// and every chunk, little-endian,
+//
+//   quint8 type | quint32 payload length | qint64 nanoseconds since start | payload
+//
+// with payloads
+//
+//   SessionInfo       char my colour ('w' / 'b'), quint32 analysis interval ms
+//   Frame             quint32 frame sequence, PNG of the 256x256 frame
+//   RecognizerOutput  bytes read from the recognizer's stdout (FENR stream)
+//   EngineResult      PackedPosition analysed (40 bytes), quint8 mate,
+//                     qint32 White's score, quint16 depth, UTF-8 best move
+//
+// Chunks are appended and flushed one by one; a log cut short by a crash
+// reads fine up to its last complete chunk.
+class SessionRecorder
+{
+public:
+    enum ChunkType : quint8 { SessionInfo = 0, Frame = 1, RecognizerOutput = 2, EngineResult = 3 };
+
+    static constexpr char Magic[4] = { 'F', 'G', 'S', 'L' };
+    static constexpr quint16 Version = 1;
+    static constexpr int FileHeaderSize = 6;
+    static constexpr int ChunkHeaderSize = 13;
+
+    static QString defaultPath();
+
+    bool open(const QString &path, char myColor, int analysisIntervalMs);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    QString fileName() const { return file.fileName(); }
+
+    // Written at open and again whenever either value changes.
+    void recordSessionInfo(char myColor, int analysisIntervalMs);
+    void recordFrame(quint32 sequence, const QByteArray &png);
+    void recordRecognizerOutput(const QByteArray &data);
+    void recordEngineResult(const PackedPosition &position, const QString &bestMove,
+                            const EngineSnapshot &snapshot);
+
+private:
+    QFile file;
+    QElapsedTimer clock;
+
+    void writeChunk(ChunkType type, const QByteArray &payload);
+};
+
+// Reads a SessionRecorder log chunk by chunk, so replaying a long session
+// never holds more than one frame.
+class SessionLogReader
+{
+public:
+    struct Chunk {
+        quint8 type = 0;
+        qint64 timestampNs = 0;
+        QByteArray payload;
+    };
+
+    bool open(const QString &path, QString *error = nullptr);
+    // False at the end of the log, or at a chunk cut short (see truncated()).
+    bool next(Chunk &chunk);
+    bool truncated() const { return cutShort; }
+
+    static bool decodeSessionInfo(const Chunk &chunk, char &myColor, int &analysisIntervalMs);
+    static bool decodeFrame(const Chunk &chunk, quint32 &sequence, QByteArray &png);
+
+private:
+    QFile file;
+    bool cutShort = false;
+};
+
+#endif // SESSIONRECORDER_H
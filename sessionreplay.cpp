@@ -0,0 +1,224 @@
+#include "sessionreplay.h"
+#include "mainwindow.h"
+#include "./ui_mainwindow.h"
+#include "latencystats.h"
+#include "startuptimeline.h"
+#include <QDebug>
+#include <QTextStream>
+#include <QTimer>
+
+SessionReplay::SessionReplay(MainWindow *mainWindow, const Options &opts, QObject *parent)
+    : QObject(parent), window(mainWindow), options(opts)
+{
+    answerTimer = new QTimer(this);
+    answerTimer->setSingleShot(true);
+    connect(answerTimer, &QTimer::timeout, this, &SessionReplay::handleTimeout);
+}
+
+void SessionReplay::start()
+{
+    QString error;
+    if (!reader.open(options.path, &error)) {
+        qWarning().noquote() << "[replay] Cannot replay" << options.path << "-" << error;
+        QTimer::singleShot(0, this, [this]() { emit finished(2); });
+        return;
+    }
+
+    // Frames come from the log only: no live capture, and nothing recorded.
+    window->replaying = true;
+    window->recorder.close();
+    if (window->analysisRunning)
+        window->on_toggleAnalysisButton_clicked();
+    window->ui->automoveCheck->setChecked(false);
+
+    connect(window, &MainWindow::recognizerAnswered, this, &SessionReplay::handleAnswer);
+    readyClock.start();
+    waitForRecognizer();
+}
+
+void SessionReplay::waitForRecognizer()
+{
+    if (StartupTimeline::at("recognizer ready") < 0) {
+        if (readyClock.elapsed() > options.readyTimeoutMs) {
+            qWarning() << "[replay] Recognizer did not start";
+            done = true;
+            emit finished(2);
+            return;
+        }
+        QTimer::singleShot(100, this, &SessionReplay::waitForRecognizer);
+        return;
+    }
+
+    qInfo().noquote() << "[replay]" << options.path << (options.maxSpeed ? "at maximum speed" : "at 1x");
+    clock.start();
+    readNextFrame();
+}
+
+void SessionReplay::readNextFrame()
+{
+    while (reader.next(chunk)) {
+        lastTimestampNs = chunk.timestampNs;
+        switch (chunk.type) {
+        case SessionRecorder::SessionInfo:
+            applySessionInfo(chunk);
+            break;
+        case SessionRecorder::RecognizerOutput:
+            collectRecordedOutput(chunk.payload);
+            break;
+        case SessionRecorder::EngineResult:
+            ++engineResults;
+            break;
+        case SessionRecorder::Frame: {
+            QByteArray png;
+            if (!SessionLogReader::decodeFrame(chunk, frameSequence, png)
+                || !frame.loadFromData(png, "PNG")) {
+                qWarning() << "[replay] Unreadable frame in the log, skipped";
+                break;
+            }
+            frame = frame.convertToFormat(QImage::Format_RGB888);
+            if (firstFrameNs < 0)
+                firstFrameNs = chunk.timestampNs;
+            if (options.maxSpeed) {
+                sendFrame();
+            } else {
+                qint64 dueNs = chunk.timestampNs - firstFrameNs;
+                qint64 waitMs = (dueNs - clock.nsecsElapsed()) / 1000000;
+                QTimer::singleShot(int(qMax<qint64>(0, waitMs)), this, &SessionReplay::sendFrame);
+            }
+            return;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (reader.truncated())
+        qWarning() << "[replay] The log ends in a partial chunk; replayed up to it";
+    logEnded = true;
+    if (inFlight.isEmpty())
+        report();
+}
+
+void SessionReplay::sendFrame()
+{
+    if (done)
+        return;
+    quint32 seq = window->submitFrame(frame);
+    ++framesSent;
+    if (seq) {
+        inFlight.insert(seq, {frameSequence, clock.nsecsElapsed()});
+        answerTimer->start(options.answerTimeoutMs);
+    } else {
+        ++errors;
+    }
+    // At 1x the next frame keeps its recorded spacing whatever the answers
+    // do; at maximum speed it waits for this one's answer.
+    if (!options.maxSpeed)
+        readNextFrame();
+    else if (!seq)
+        QTimer::singleShot(0, this, &SessionReplay::readNextFrame);
+}
+
+void SessionReplay::handleAnswer(const RecognizerMessage &msg)
+{
+    auto it = inFlight.find(msg.sequence);
+    if (done || it == inFlight.end())
+        return;
+
+    roundTripsMs.append((clock.nsecsElapsed() - it->sentAt) / 1e6);
+    const quint32 recorded = it->recordedSequence;
+    inFlight.erase(it);
+    switch (msg.type) {
+    case RecognizerMessage::Result:
+        ++results;
+        replayedResults.insert(recorded, msg.position());
+        break;
+    case RecognizerMessage::Skip:
+        ++skipped;
+        break;
+    default:
+        ++errors;
+        break;
+    }
+
+    if (inFlight.isEmpty())
+        answerTimer->stop();
+    if (logEnded) {
+        if (inFlight.isEmpty())
+            report();
+    } else if (options.maxSpeed) {
+        readNextFrame();
+    }
+}
+
+void SessionReplay::handleTimeout()
+{
+    if (done)
+        return;
+    qWarning() << "[replay] No answer for" << options.answerTimeoutMs << "ms, stopping";
+    report();
+}
+
+void SessionReplay::applySessionInfo(const SessionLogReader::Chunk &info)
+{
+    char color = 'w';
+    int interval = 0;
+    if (!SessionLogReader::decodeSessionInfo(info, color, interval))
+        return;
+    if (color == 'b')
+        window->ui->blackRadioButton->setChecked(true);
+    else
+        window->ui->whiteRadioButton->setChecked(true);
+}
+
+void SessionReplay::collectRecordedOutput(const QByteArray &data)
+{
+    recordedParser.append(data);
+    while (recordedParser.next(recordedMessage)) {
+        if (recordedMessage.type == RecognizerMessage::Result)
+            recordedResults.insert(recordedMessage.sequence, recordedMessage.position());
+    }
+}
+
+void SessionReplay::report()
+{
+    if (done)
+        return;
+    done = true;
+    answerTimer->stop();
+    window->replaying = false;
+
+    // Frames recognized in one run but not the other count as differing.
+    int differing = 0;
+    for (auto it = recordedResults.cbegin(); it != recordedResults.cend(); ++it) {
+        auto replayed = replayedResults.constFind(it.key());
+        if (replayed == replayedResults.cend() || *replayed != it.value())
+            ++differing;
+    }
+    for (auto it = replayedResults.cbegin(); it != replayedResults.cend(); ++it) {
+        if (!recordedResults.contains(it.key()))
+            ++differing;
+    }
+
+    const double wallSeconds = clock.nsecsElapsed() / 1e9;
+    const double recordedSeconds = firstFrameNs < 0 ? 0.0 : (lastTimestampNs - firstFrameNs) / 1e9;
+    const int unanswered = inFlight.size();
+
+    QTextStream out(stdout);
+    out << "replay: " << options.path << (options.maxSpeed ? " at maximum speed\n" : " at 1x\n");
+    out << QString("  %1 frames sent: %2 results, %3 skipped, %4 errors, %5 unanswered\n")
+               .arg(framesSent).arg(results).arg(skipped).arg(errors).arg(unanswered);
+    out << QString("  %1 s for %2 s recorded (%3 frames/s)\n")
+               .arg(wallSeconds, 0, 'f', 1)
+               .arg(recordedSeconds, 0, 'f', 1)
+               .arg(wallSeconds > 0 ? framesSent / wallSeconds : 0.0, 0, 'f', 1);
+    if (!roundTripsMs.isEmpty())
+        out << "  round trip " << LatencyStats::of(roundTripsMs).summary() << "\n";
+    out << QString("  recognition differs from the recording on %1 of %2 recorded results\n")
+               .arg(differing).arg(recordedResults.size());
+    out << QString("  game: %1 moves tracked; %2 engine results in the log\n")
+               .arg(int(window->game.moves().size())).arg(engineResults);
+    out.flush();
+
+    emit finished(differing > 0 || unanswered > 0 ? 1 : 0);
+}
@@ -0,0 +1,89 @@
+#ifndef SESSIONREPLAY_H
+#define SESSIONREPLAY_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QVector>
+#include "packedposition.h"
+#include "recognizerprotocol.h"
+#include "sessionrecorder.h"
+
+class MainWindow;
+class QTimer;
+
+// Feeds a SessionRecorder log back through the main window: every recorded
+// frame goes to the recognizer (change gating included), its answers to
+// the decoder and GameTracker, and from there to the engine, like a live
+// capture. At 1x frames are sent with their recorded spacing; at maximum
+// speed each frame follows the previous frame's answer. The recognizer
+// gates on frame order, not time, so maximum speed is deterministic; 1x is
+// too as long as the recognizer keeps up with the recorded frame rate.
+//
+// The report compares the replayed recognition with the recording's, so a
+// changed model or pipeline shows up as differing frames, and gives round
+// trip times for performance regression runs.
+class SessionReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString path;
+        bool maxSpeed = false;
+        int readyTimeoutMs = 60000;   // recognizer start-up allowance
+        int answerTimeoutMs = 10000;  // give up when no frame is answered for this long
+    };
+
+    SessionReplay(MainWindow *window, const Options &options, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    struct InFlight {
+        quint32 recordedSequence = 0;
+        qint64 sentAt = 0;
+    };
+
+    void waitForRecognizer();
+    void readNextFrame();
+    void sendFrame();
+    void handleAnswer(const RecognizerMessage &msg);
+    void handleTimeout();
+    void applySessionInfo(const SessionLogReader::Chunk &info);
+    void collectRecordedOutput(const QByteArray &data);
+    void report();
+
+    MainWindow *window;
+    Options options;
+    SessionLogReader reader;
+    SessionLogReader::Chunk chunk;
+    QTimer *answerTimer = nullptr;
+    QElapsedTimer clock;
+    QElapsedTimer readyClock;
+
+    RecognizerStreamParser recordedParser;
+    RecognizerMessage recordedMessage;
+    QHash<quint32, PackedPosition> recordedResults;  // recorded sequence -> position
+    QHash<quint32, PackedPosition> replayedResults;  // recorded sequence -> position
+    QHash<quint32, InFlight> inFlight;               // replay sequence -> frame
+
+    QImage frame;
+    quint32 frameSequence = 0;     // as recorded
+    qint64 firstFrameNs = -1;
+    qint64 lastTimestampNs = 0;
+    bool logEnded = false;
+    bool done = false;
+    int framesSent = 0;
+    int results = 0;
+    int skipped = 0;
+    int errors = 0;
+    int engineResults = 0;         // recorded, for the report
+    QVector<double> roundTripsMs;
+};
+
+#endif // SESSIONREPLAY_H
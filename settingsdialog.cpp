@@ -11,6 +11,7 @@
 #include <QVBoxLayout>
 #include <QFileDialog>
 #include <QCoreApplication>
+#include "enginebackend.h"
 
 SettingsDialog::SettingsDialog(QWidget *parent)
     : QDialog(parent), settings("ChessGUI", "ChessGUI")
@@ -30,6 +31,20 @@ SettingsDialog::SettingsDialog(QWidget *parent)
 
     stealthCheckBox = new QCheckBox(tr("Enable Stealth Mode"), coreTab);
     coreLayout->addRow(stealthCheckBox);
+
+    arrowLinesSpinBox = new QSpinBox(coreTab);
+    arrowLinesSpinBox->setRange(1, 5);
+    coreLayout->addRow(tr("Arrow Lines (MultiPV)"), arrowLinesSpinBox);
+
+    pvPliesSpinBox = new QSpinBox(coreTab);
+    pvPliesSpinBox->setRange(0, 8);
+    coreLayout->addRow(tr("Principal Variation Plies"), pvPliesSpinBox);
+
+    refreshRateSpinBox = new QSpinBox(coreTab);
+    refreshRateSpinBox->setRange(0, 240);
+    refreshRateSpinBox->setSpecialValueText(tr("Display rate"));
+    refreshRateSpinBox->setSuffix(tr(" Hz"));
+    coreLayout->addRow(tr("Analysis Display Updates"), refreshRateSpinBox);
     coreTab->setLayout(coreLayout);
     tabs->addTab(coreTab, tr("Core"));
 
@@ -40,6 +55,8 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     forceManualRegionCheckBox = new QCheckBox(tr("Force Manual Region on Startup"), boardTab);
     boardLayout->addWidget(autoBoardDetectCheckBox);
     boardLayout->addWidget(forceManualRegionCheckBox);
+    trackBoardCheckBox = new QCheckBox(tr("Follow the Board When It Moves"), boardTab);
+    boardLayout->addWidget(trackBoardCheckBox);
     boardTab->setLayout(boardLayout);
     tabs->addTab(boardTab, tr("Board Detection"));
 
@@ -59,6 +76,11 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     // Misc tab
     QWidget *miscTab = new QWidget(this);
     QFormLayout *miscLayout = new QFormLayout(miscTab);
+    engineBackendComboBox = new QComboBox(miscTab);
+    for (int kind : {EngineBackend::Stockfish, EngineBackend::GenericUci, EngineBackend::Mock})
+        engineBackendComboBox->addItem(EngineBackend::kindName(EngineBackend::Kind(kind)), kind);
+    miscLayout->addRow(tr("Engine Backend"), engineBackendComboBox);
+
     QHBoxLayout *stockfishLayout = new QHBoxLayout();
     stockfishPathEdit = new QLineEdit(miscTab);
     stockfishBrowseButton = new QPushButton(tr("Browse"), miscTab);
@@ -66,7 +88,7 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     stockfishLayout->addWidget(stockfishBrowseButton);
     QWidget *stockfishWidget = new QWidget(miscTab);
     stockfishWidget->setLayout(stockfishLayout);
-    miscLayout->addRow(tr("Path to Stockfish Executable"), stockfishWidget);
+    miscLayout->addRow(tr("Path to Engine Executable"), stockfishWidget);
 
     QHBoxLayout *fenLayout = new QHBoxLayout();
     fenModelPathEdit = new QLineEdit(miscTab);
@@ -80,6 +102,9 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     colorComboBox = new QComboBox(miscTab);
     colorComboBox->addItems({tr("White"), tr("Black")});
     miscLayout->addRow(tr("Default Player Color"), colorComboBox);
+
+    recordSessionsCheckBox = new QCheckBox(tr("Record Sessions for Replay (Troubleshooting)"), miscTab);
+    miscLayout->addRow(recordSessionsCheckBox);
     miscTab->setLayout(miscLayout);
     tabs->addTab(miscTab, tr("Misc"));
 
@@ -113,9 +138,13 @@ void SettingsDialog::loadSettings()
     setAnalysisInterval(settings.value("analysisInterval", 1000).toInt());
     setStockfishDepth(settings.value("stockfishDepth", 15).toInt());
     setStealthModeEnabled(settings.value("stealthMode", false).toBool());
+    setArrowLines(settings.value("arrowLines", 1).toInt());
+    setPvArrowPlies(settings.value("pvArrowPlies", 0).toInt());
+    setUiRefreshRate(settings.value("uiRefreshRate", 0).toInt());
 
     setUseAutoBoardDetection(settings.value("autoBoardDetection", true).toBool());
     setForceManualRegion(settings.value("forceManualRegion", false).toBool());
+    setTrackBoard(settings.value("trackBoard", true).toBool());
 
 
     setAutoMoveWhenReady(settings.value("autoMoveWhenReady", false).toBool());
@@ -123,11 +152,13 @@ void SettingsDialog::loadSettings()
 
 
     QString defaultStockfish = QCoreApplication::applicationDirPath() + "/stockfish.exe";
-    QString defaultFenModel = QCoreApplication::applicationDirPath() + "/python/fen_tracker/ccn_model_default.pth";
+    QString defaultFenModel = QCoreApplication::applicationDirPath() + "/python/fen_tracker/models.json";
 
     setStockfishPath(settings.value("stockfishPath", defaultStockfish).toString());
+    setEngineBackend(settings.value("engineBackend", EngineBackend::Stockfish).toInt());
     setFenModelPath(settings.value("fenModelPath", defaultFenModel).toString());
     setDefaultPlayerColor(settings.value("defaultColor", "White").toString());
+    setRecordSessions(settings.value("recordSessions", false).toBool());
 }
 
 void SettingsDialog::saveSettings()
@@ -135,13 +166,19 @@ void SettingsDialog::saveSettings()
     settings.setValue("analysisInterval", analysisInterval());
     settings.setValue("stockfishDepth", stockfishDepth());
     settings.setValue("stealthMode", stealthModeEnabled());
+    settings.setValue("arrowLines", arrowLines());
+    settings.setValue("pvArrowPlies", pvArrowPlies());
+    settings.setValue("uiRefreshRate", uiRefreshRate());
     settings.setValue("autoBoardDetection", useAutoBoardDetection());
     settings.setValue("forceManualRegion", forceManualRegion());
+    settings.setValue("trackBoard", trackBoard());
     settings.setValue("autoMoveWhenReady", autoMoveWhenReady());
     settings.setValue("autoMoveDelay", autoMoveDelay());
     settings.setValue("stockfishPath", stockfishPath());
+    settings.setValue("engineBackend", engineBackend());
     settings.setValue("fenModelPath", fenModelPath());
     settings.setValue("defaultColor", defaultPlayerColor());
+    settings.setValue("recordSessions", recordSessions());
 }
 
 void SettingsDialog::accept()
@@ -152,14 +189,15 @@ void SettingsDialog::accept()
 
 void SettingsDialog::browseStockfish()
 {
-    QString file = QFileDialog::getOpenFileName(this, tr("Select Stockfish Executable"));
+    QString file = QFileDialog::getOpenFileName(this, tr("Select Engine Executable"));
     if (!file.isEmpty())
         stockfishPathEdit->setText(file);
 }
 
 void SettingsDialog::browseFenModel()
 {
-    QString file = QFileDialog::getOpenFileName(this, tr("Select FEN Model"));
+    QString file = QFileDialog::getOpenFileName(this, tr("Select FEN Model"), QString(),
+                                                tr("Models (*.json *.pth *.pt);;All Files (*)"));
     if (!file.isEmpty())
         fenModelPathEdit->setText(file);
 }
@@ -169,13 +207,19 @@ void SettingsDialog::resetDefaults()
     setAnalysisInterval(1000);
     setStockfishDepth(15);
     setStealthModeEnabled(false);
+    setArrowLines(1);
+    setPvArrowPlies(0);
+    setUiRefreshRate(0);
     setUseAutoBoardDetection(true);
     setForceManualRegion(false);
+    setTrackBoard(true);
     setAutoMoveWhenReady(false);
     setAutoMoveDelay(0);
     setStockfishPath(QCoreApplication::applicationDirPath() + "/stockfish.exe");
-    setFenModelPath(QCoreApplication::applicationDirPath() + "/python/fen_tracker/ccn_model_default.pth");
+    setEngineBackend(EngineBackend::Stockfish);
+    setFenModelPath(QCoreApplication::applicationDirPath() + "/python/fen_tracker/models.json");
     setDefaultPlayerColor("White");
+    setRecordSessions(false);
 }
 
 // Getter and setter implementations
@@ -209,6 +253,36 @@ bool SettingsDialog::stealthModeEnabled() const
     return stealthCheckBox->isChecked();
 }
 
+void SettingsDialog::setArrowLines(int lines)
+{
+    arrowLinesSpinBox->setValue(lines);
+}
+
+int SettingsDialog::arrowLines() const
+{
+    return arrowLinesSpinBox->value();
+}
+
+void SettingsDialog::setPvArrowPlies(int plies)
+{
+    pvPliesSpinBox->setValue(plies);
+}
+
+int SettingsDialog::pvArrowPlies() const
+{
+    return pvPliesSpinBox->value();
+}
+
+void SettingsDialog::setUiRefreshRate(int hz)
+{
+    refreshRateSpinBox->setValue(hz);
+}
+
+int SettingsDialog::uiRefreshRate() const
+{
+    return refreshRateSpinBox->value();
+}
+
 void SettingsDialog::setUseAutoBoardDetection(bool use)
 {
     autoBoardDetectCheckBox->setChecked(use);
@@ -229,6 +303,16 @@ bool SettingsDialog::forceManualRegion() const
     return forceManualRegionCheckBox->isChecked();
 }
 
+void SettingsDialog::setTrackBoard(bool track)
+{
+    trackBoardCheckBox->setChecked(track);
+}
+
+bool SettingsDialog::trackBoard() const
+{
+    return trackBoardCheckBox->isChecked();
+}
+
 
 void SettingsDialog::setAutoMoveWhenReady(bool enable)
 {
@@ -261,6 +345,18 @@ QString SettingsDialog::stockfishPath() const
     return stockfishPathEdit->text();
 }
 
+void SettingsDialog::setEngineBackend(int kind)
+{
+    int index = engineBackendComboBox->findData(kind);
+    if (index >= 0)
+        engineBackendComboBox->setCurrentIndex(index);
+}
+
+int SettingsDialog::engineBackend() const
+{
+    return engineBackendComboBox->currentData().toInt();
+}
+
 void SettingsDialog::setFenModelPath(const QString &path)
 {
     fenModelPathEdit->setText(path);
@@ -283,3 +379,13 @@ QString SettingsDialog::defaultPlayerColor() const
     return colorComboBox->currentText();
 }
 
+void SettingsDialog::setRecordSessions(bool record)
+{
+    recordSessionsCheckBox->setChecked(record);
+}
+
+bool SettingsDialog::recordSessions() const
+{
+    return recordSessionsCheckBox->isChecked();
+}
+
@@ -28,12 +28,20 @@ public:
     int stockfishDepth() const;
     void setStealthModeEnabled(bool enabled);
     bool stealthModeEnabled() const;
+    void setArrowLines(int lines);
+    int arrowLines() const;
+    void setPvArrowPlies(int plies);
+    int pvArrowPlies() const;
+    void setUiRefreshRate(int hz);
+    int uiRefreshRate() const;
 
     // Board detection
     void setUseAutoBoardDetection(bool use);
     bool useAutoBoardDetection() const;
     void setForceManualRegion(bool force);
     bool forceManualRegion() const;
+    void setTrackBoard(bool track);
+    bool trackBoard() const;
 
     // Move automation
     void setAutoMoveWhenReady(bool enable);
@@ -44,10 +52,14 @@ public:
     // Misc
     void setStockfishPath(const QString &path);
     QString stockfishPath() const;
+    void setEngineBackend(int kind);
+    int engineBackend() const;
     void setFenModelPath(const QString &path);
     QString fenModelPath() const;
     void setDefaultPlayerColor(const QString &color);
     QString defaultPlayerColor() const;
+    void setRecordSessions(bool record);
+    bool recordSessions() const;
 
 signals:
     void resetPgnRequested();
@@ -66,16 +78,22 @@ private:
     QSpinBox *intervalSpinBox;
     QSpinBox *depthSpinBox;
     QCheckBox *stealthCheckBox;
+    QSpinBox *arrowLinesSpinBox;
+    QSpinBox *pvPliesSpinBox;
+    QSpinBox *refreshRateSpinBox;
 
     QCheckBox *autoBoardDetectCheckBox;
     QCheckBox *forceManualRegionCheckBox;
+    QCheckBox *trackBoardCheckBox;
     QCheckBox *autoMoveCheckBox;
     QSpinBox *autoMoveDelaySpinBox;
+    QComboBox *engineBackendComboBox;
     QLineEdit *stockfishPathEdit;
     QPushButton *stockfishBrowseButton;
     QLineEdit *fenModelPathEdit;
     QPushButton *fenModelBrowseButton;
     QComboBox *colorComboBox;
+    QCheckBox *recordSessionsCheckBox;
 
     QPushButton *resetButton;
     QDialogButtonBox *buttonBox;
@@ -0,0 +1,56 @@
+#include "startuptimeline.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QVector>
+#include <cstring>
+
+namespace {
+struct Milestone {
+    const char *name;
+    qint64 ms;
+};
+
+QElapsedTimer clock;
+QVector<Milestone> milestones;
+}
+
+namespace StartupTimeline {
+
+void start() {
+    clock.start();
+    milestones.reserve(16);
+}
+
+qint64 now() {
+    return clock.isValid() ? clock.elapsed() : 0;
+}
+
+qint64 at(const char *name) {
+    for (const Milestone &m : milestones) {
+        if (std::strcmp(m.name, name) == 0)
+            return m.ms;
+    }
+    return -1;
+}
+
+qint64 mark(const char *name) {
+    qint64 existing = at(name);
+    if (existing >= 0)
+        return existing;
+    qint64 ms = now();
+    milestones.append({name, ms});
+    qDebug() << "[startup]" << name << ms << "ms";
+    return ms;
+}
+
+QString summary() {
+    QString text;
+    for (const Milestone &m : milestones) {
+        if (!text.isEmpty())
+            text += '\n';
+        text += QString("%1 %2 ms").arg(QString::fromLatin1(m.name)).arg(m.ms);
+    }
+    return text;
+}
+
+}
@@ -0,0 +1,20 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QString>
+
+// Milestones from process start to the first analysed position, in
+// milliseconds since start(). Each name is recorded once (the first mark
+// wins), so restarts of a subsystem don't overwrite its startup time.
+// GUI thread only.
+namespace StartupTimeline {
+
+void start();                    // first thing in main()
+qint64 now();                    // ms since start()
+qint64 mark(const char *name);   // records and logs name; returns its time
+qint64 at(const char *name);     // recorded time, or -1
+QString summary();               // "name 123 ms" lines in recording order
+
+}
+
+#endif // STARTUPTIMELINE_H
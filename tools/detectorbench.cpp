@@ -0,0 +1,447 @@
+// Accuracy and latency regression bench for the board detector.
+//
+// Renders a deterministic corpus of synthetic desktops: windows, text,
+// square thumbnails and a spreadsheet-like grid as distractors, plus one
+// board in a random theme, size, position and devicePixelRatio with the
+// bundled piece SVGs on it. Labelled real screenshots can be added with
+// --corpus. Every image goes through detectBoardGeometry() and the bench
+// reports IoU against the label, the worst grid line error and milliseconds
+// per image, overall and per theme / DPR.
+//
+// Usage: DetectorBench [--count N] [--seed S] [--corpus DIR] [--write DIR]
+//                      [--csv FILE] [--min-iou X] [--min-hit-rate X] [--verbose]
+//   --count         synthetic desktops to render (default 48)
+//   --seed          corpus seed, same seed = same images (default 1)
+//   --corpus        directory with labels.csv lines "file,x,y,width,height[,dpr]",
+//                   rect in logical pixels, dpr defaults to 1
+//   --write         save the synthetic images and their labels.csv to DIR, in
+//                   the --corpus format
+//   --csv           per-image results
+//   --min-iou       IoU that counts as a hit (default 0.95)
+//   --min-hit-rate  exit with status 1 below this fraction of hits (default 0.9)
+//
+// Exit status 1 when the hit rate is below --min-hit-rate, so a detector
+// change that trades accuracy for speed fails visibly.
+
+#include "../chessboard_detector.h"
+#include "../latencystats.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QLinearGradient>
+#include <QMap>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QSvgRenderer>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+
+namespace {
+
+struct Theme {
+    const char* name;
+    QColor light;
+    QColor dark;
+};
+
+const Theme kThemes[] = {
+    {"brown", QColor("#f0d9b5"), QColor("#b58863")},
+    {"green", QColor("#eeeed2"), QColor("#769656")},
+    {"blue", QColor("#dee3e6"), QColor("#8ca2ad")},
+    {"gray", QColor("#e0e0e0"), QColor("#a0a0a0")},
+};
+
+const QSize kDesktops[] = {QSize(1366, 768), QSize(1920, 1080), QSize(2560, 1440)};
+const double kDprs[] = {1.0, 1.25, 1.5, 2.0};
+
+const char* const kPlacements[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR",
+    "r1bq1rk1/2p1bppp/p1np1n2/1p2p3/4P3/1BP2N1P/PP1P1PP1/RNBQR1K1",
+    "8/5pk1/6p1/3R4/1r5P/6P1/5PK1/8",
+    "2kr3r/ppp2ppp/2n1b3/4q3/4P3/2N1B3/PPP1QPPP/2KR3R",
+};
+
+struct Case {
+    QString name;
+    QImage image;        // devicePixelRatio set
+    QRectF truth;        // logical pixels
+    QString theme;       // "-" for external screenshots
+    double dpr = 1.0;
+};
+
+struct Result {
+    double iou = 0.0;
+    double lineError = -1.0;  // worst grid line error, logical px; -1 = missed
+    double ms = 0.0;
+};
+
+class DesktopRenderer
+{
+public:
+    explicit DesktopRenderer(const QString& pieceDir) {
+        const QString names = "PNBRQKpnbrqk";
+        for (QChar c : names) {
+            QString file = QString("%1/%2%3.svg")
+                               .arg(pieceDir)
+                               .arg(c.isUpper() ? 'w' : 'b')
+                               .arg(c.toUpper());
+            auto renderer = std::make_shared<QSvgRenderer>(file);
+            if (renderer->isValid())
+                pieces.insert(c, renderer);
+            else
+                qWarning() << "Cannot load" << file;
+        }
+    }
+
+    Case render(QRandomGenerator& rng, int index) const {
+        const QSize desktop = kDesktops[rng.bounded(int(std::size(kDesktops)))];
+        const double dpr = kDprs[rng.bounded(int(std::size(kDprs)))];
+        const Theme& theme = kThemes[rng.bounded(int(std::size(kThemes)))];
+
+        QImage image(int(std::ceil(desktop.width() * dpr)), int(std::ceil(desktop.height() * dpr)),
+                     QImage::Format_RGB32);
+        image.setDevicePixelRatio(dpr);
+
+        QPainter p(&image);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setRenderHint(QPainter::SmoothPixmapTransform);
+
+        QLinearGradient wallpaper(0, 0, 0, desktop.height());
+        wallpaper.setColorAt(0, randomColor(rng, 20, 120));
+        wallpaper.setColorAt(1, randomColor(rng, 20, 120));
+        p.fillRect(QRect(QPoint(0, 0), desktop), wallpaper);
+
+        for (int i = 0, n = 3 + rng.bounded(4); i < n; ++i)
+            drawWindow(p, rng, desktop);
+        for (int i = 0, n = 1 + rng.bounded(2); i < n; ++i)
+            drawThumbnail(p, rng, desktop);
+        if (rng.bounded(2))
+            drawSpreadsheet(p, rng, desktop);
+
+        const double size = std::max(240.0, desktop.height() * (0.3 + 0.5 * rng.generateDouble()));
+        const QRectF board(rng.generateDouble() * (desktop.width() - size),
+                           rng.generateDouble() * (desktop.height() - size), size, size);
+        drawBoard(p, rng, board, theme, kPlacements[rng.bounded(int(std::size(kPlacements)))]);
+        p.end();
+
+        Case c;
+        c.name = QString("synthetic_%1").arg(index, 3, 10, QChar('0'));
+        c.image = image;
+        c.truth = board;
+        c.theme = theme.name;
+        c.dpr = dpr;
+        return c;
+    }
+
+private:
+    QMap<QChar, std::shared_ptr<QSvgRenderer>> pieces;
+
+    static QColor randomColor(QRandomGenerator& rng, int lo, int hi) {
+        return QColor(lo + rng.bounded(hi - lo), lo + rng.bounded(hi - lo), lo + rng.bounded(hi - lo));
+    }
+
+    static QRectF randomRect(QRandomGenerator& rng, const QSize& desktop, double minSide, double maxSide,
+                             bool square) {
+        double w = minSide + rng.generateDouble() * (maxSide - minSide);
+        double h = square ? w : minSide + rng.generateDouble() * (maxSide - minSide);
+        return QRectF(rng.generateDouble() * std::max(1.0, desktop.width() - w),
+                      rng.generateDouble() * std::max(1.0, desktop.height() - h), w, h);
+    }
+
+    static void drawWindow(QPainter& p, QRandomGenerator& rng, const QSize& desktop) {
+        QRectF r = randomRect(rng, desktop, 200, desktop.height() * 0.9, false);
+        p.fillRect(r, randomColor(rng, 30, 250));
+        p.fillRect(QRectF(r.topLeft(), QSizeF(r.width(), 28)), randomColor(rng, 40, 200));
+        p.setPen(randomColor(rng, 0, 255));
+        for (double y = r.top() + 50; y < r.bottom() - 10; y += 18 + rng.bounded(10))
+            p.drawText(QPointF(r.left() + 12, y), "Lorem ipsum dolor sit amet 1. e4 e5 2. Nf3 Nc6");
+    }
+
+    // Square, busy and high contrast: what the old largest-square
+    // heuristic used to lock onto.
+    static void drawThumbnail(QPainter& p, QRandomGenerator& rng, const QSize& desktop) {
+        QRectF r = randomRect(rng, desktop, 120, desktop.height() * 0.5, true);
+        QLinearGradient g(r.topLeft(), r.bottomRight());
+        g.setColorAt(0, randomColor(rng, 0, 255));
+        g.setColorAt(1, randomColor(rng, 0, 255));
+        p.fillRect(r, g);
+        for (int i = 0; i < 6; ++i) {
+            p.setBrush(randomColor(rng, 0, 255));
+            p.setPen(Qt::NoPen);
+            double d = r.width() * (0.1 + 0.3 * rng.generateDouble());
+            p.drawEllipse(QRectF(r.left() + rng.generateDouble() * (r.width() - d),
+                                 r.top() + rng.generateDouble() * (r.height() - d), d, d));
+        }
+        p.setBrush(Qt::NoBrush);
+        p.setPen(QPen(Qt::black, 2));
+        p.drawRect(r);
+    }
+
+    // Regular lines on both axes but no alternating squares.
+    static void drawSpreadsheet(QPainter& p, QRandomGenerator& rng, const QSize& desktop) {
+        QRectF r = randomRect(rng, desktop, 240, desktop.height() * 0.7, true);
+        p.fillRect(r, Qt::white);
+        p.setPen(QPen(QColor(180, 180, 180), 1));
+        double cell = r.width() / 8.0;
+        for (int k = 0; k <= 8; ++k) {
+            p.drawLine(QPointF(r.left() + k * cell, r.top()), QPointF(r.left() + k * cell, r.bottom()));
+            p.drawLine(QPointF(r.left(), r.top() + k * cell), QPointF(r.right(), r.top() + k * cell));
+        }
+    }
+
+    void drawBoard(QPainter& p, QRandomGenerator& rng, const QRectF& board, const Theme& theme,
+                   const QString& placement) const {
+        if (rng.bounded(2)) {
+            double frame = 2 + rng.bounded(12);
+            p.fillRect(board.adjusted(-frame, -frame, frame, frame), randomColor(rng, 20, 90));
+        }
+
+        const double tile = board.width() / 8.0;
+        auto square = [&](int row, int col) {
+            return QRectF(board.left() + col * tile, board.top() + row * tile, tile, tile);
+        };
+        for (int row = 0; row < 8; ++row) {
+            for (int col = 0; col < 8; ++col)
+                p.fillRect(square(row, col), (row + col) % 2 ? theme.dark : theme.light);
+        }
+
+        // Last-move highlight on two squares.
+        QColor highlight(255, 255, 0, 90);
+        p.fillRect(square(rng.bounded(8), rng.bounded(8)), highlight);
+        p.fillRect(square(rng.bounded(8), rng.bounded(8)), highlight);
+
+        if (rng.bounded(2)) {
+            QFont font = p.font();
+            font.setPixelSize(std::max(8, int(tile * 0.18)));
+            p.setFont(font);
+            for (int k = 0; k < 8; ++k) {
+                p.setPen(k % 2 ? theme.light : theme.dark);
+                p.drawText(square(k, 0).adjusted(3, 2, 0, 0), Qt::AlignLeft | Qt::AlignTop,
+                           QString::number(8 - k));
+                p.setPen((k + 1) % 2 ? theme.light : theme.dark);
+                p.drawText(square(7, k).adjusted(0, 0, -3, -2), Qt::AlignRight | Qt::AlignBottom,
+                           QString(QChar('a' + k)));
+            }
+        }
+
+        int row = 0, col = 0;
+        for (QChar c : placement) {
+            if (c == '/') {
+                ++row;
+                col = 0;
+            } else if (c.isDigit()) {
+                col += c.digitValue();
+            } else {
+                auto it = pieces.constFind(c);
+                if (it != pieces.constEnd())
+                    it.value()->render(&p, square(row, col).adjusted(tile * 0.05, tile * 0.05,
+                                                                     -tile * 0.05, -tile * 0.05));
+                ++col;
+            }
+        }
+    }
+};
+
+QList<Case> loadCorpus(const QString& dir) {
+    QList<Case> cases;
+    QFile labels(QDir(dir).filePath("labels.csv"));
+    if (!labels.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Cannot read" << labels.fileName();
+        return cases;
+    }
+    QTextStream in(&labels);
+    while (!in.atEnd()) {
+        QStringList f = in.readLine().trimmed().split(',');
+        if (f.size() < 5 || f[0].startsWith('#') || f[0] == "file")
+            continue;
+        Case c;
+        c.name = f[0];
+        c.image = QImage(QDir(dir).filePath(f[0]));
+        if (c.image.isNull()) {
+            qWarning() << "Cannot load" << f[0];
+            continue;
+        }
+        c.dpr = f.size() > 5 ? f[5].toDouble() : 1.0;
+        c.image.setDevicePixelRatio(c.dpr);
+        c.truth = QRectF(f[1].toDouble(), f[2].toDouble(), f[3].toDouble(), f[4].toDouble());
+        c.theme = "-";
+        cases.append(c);
+    }
+    return cases;
+}
+
+void writeCorpus(const QString& dir, const QList<Case>& cases) {
+    QDir().mkpath(dir);
+    QFile labels(QDir(dir).filePath("labels.csv"));
+    if (!labels.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Cannot write" << labels.fileName();
+        return;
+    }
+    QTextStream out(&labels);
+    out << "file,x,y,width,height,dpr\n";
+    for (const Case& c : cases) {
+        QString file = c.name + ".png";
+        c.image.save(QDir(dir).filePath(file));
+        out << file << ',' << c.truth.x() << ',' << c.truth.y() << ',' << c.truth.width() << ','
+            << c.truth.height() << ',' << c.dpr << '\n';
+    }
+}
+
+double intersectionOverUnion(const QRectF& a, const QRectF& b) {
+    QRectF inter = a.intersected(b);
+    double i = inter.width() * inter.height();
+    double u = a.width() * a.height() + b.width() * b.height() - i;
+    return u > 0.0 ? i / u : 0.0;
+}
+
+Result evaluate(const Case& c) {
+    Result r;
+    QElapsedTimer timer;
+    timer.start();
+    BoardGeometry g = detectBoardGeometry(c.image);
+    r.ms = timer.nsecsElapsed() / 1e6;
+    if (!g.isValid())
+        return r;
+
+    r.iou = intersectionOverUnion(g.outerRect(), c.truth);
+    const double tile = c.truth.width() / 8.0;
+    r.lineError = 0.0;
+    for (int k = 0; k <= 8; ++k) {
+        r.lineError = std::max(r.lineError, std::abs(g.files[k] - (c.truth.left() + k * tile)));
+        r.lineError = std::max(r.lineError, std::abs(g.ranks[k] - (c.truth.top() + k * tile)));
+    }
+    return r;
+}
+
+struct Summary {
+    int count = 0;
+    int hits = 0;
+    double iouSum = 0.0;
+    QVector<double> ms;
+
+    void add(const Result& r, double minIou) {
+        ++count;
+        hits += r.iou >= minIou;
+        iouSum += r.iou;
+        ms.append(r.ms);
+    }
+
+    QString line() const {
+        const LatencyStats stats = LatencyStats::of(ms);
+        return QString("%1/%2 hits  mean IoU %3  %4 ms/image (p50 %5, p90 %6)")
+            .arg(hits)
+            .arg(count)
+            .arg(count ? iouSum / count : 0.0, 0, 'f', 3)
+            .arg(stats.mean, 0, 'f', 1)
+            .arg(stats.p50, 0, 'f', 1)
+            .arg(stats.p90, 0, 'f', 1);
+    }
+};
+
+bool verbose = false;
+
+void messageHandler(QtMsgType type, const QMessageLogContext&, const QString& msg) {
+    // The detector logs every call; keep the report readable.
+    if (type == QtDebugMsg && !verbose)
+        return;
+    QTextStream(stderr) << msg << '\n';
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    qInstallMessageHandler(messageHandler);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Board detector accuracy and latency bench");
+    parser.addHelpOption();
+    QCommandLineOption countOption("count", "Synthetic desktops to render.", "n", "48");
+    QCommandLineOption seedOption("seed", "Corpus seed.", "seed", "1");
+    QCommandLineOption corpusOption("corpus", "Directory of labelled screenshots.", "dir");
+    QCommandLineOption writeOption("write", "Save the synthetic corpus to a directory.", "dir");
+    QCommandLineOption csvOption("csv", "Per-image results.", "file");
+    QCommandLineOption minIouOption("min-iou", "IoU that counts as a hit.", "x", "0.95");
+    QCommandLineOption minHitRateOption("min-hit-rate", "Fail below this hit rate.", "x", "0.9");
+    QCommandLineOption piecesOption("pieces", "Piece SVG directory.", "dir",
+                                    QStringLiteral(CHESSGUI_ASSETS_DIR "/pieces"));
+    QCommandLineOption verboseOption("verbose", "Show detector log output.");
+    parser.addOptions({countOption, seedOption, corpusOption, writeOption, csvOption, minIouOption,
+                       minHitRateOption, piecesOption, verboseOption});
+    parser.process(app);
+    verbose = parser.isSet(verboseOption);
+
+    QList<Case> cases;
+    QRandomGenerator rng(parser.value(seedOption).toUInt());
+    DesktopRenderer renderer(parser.value(piecesOption));
+    for (int i = 0, n = parser.value(countOption).toInt(); i < n; ++i)
+        cases.append(renderer.render(rng, i));
+    if (parser.isSet(writeOption))
+        writeCorpus(parser.value(writeOption), cases);
+    if (parser.isSet(corpusOption))
+        cases += loadCorpus(parser.value(corpusOption));
+    if (cases.isEmpty()) {
+        qWarning() << "Empty corpus";
+        return 1;
+    }
+
+    const double minIou = parser.value(minIouOption).toDouble();
+    QTextStream out(stdout);
+
+    // First call pays for OpenCV's thread pool start-up.
+    detectBoardGeometry(cases.first().image);
+
+    QFile csv(parser.value(csvOption));
+    QTextStream csvStream;
+    if (parser.isSet(csvOption)) {
+        if (csv.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            csvStream.setDevice(&csv);
+            csvStream << "image,theme,dpr,iou,line_error_px,ms\n";
+        } else {
+            qWarning() << "Cannot write" << csv.fileName();
+        }
+    }
+
+    Summary overall;
+    QMap<QString, Summary> byTheme;
+    QMap<double, Summary> byDpr;
+    QList<double> lineErrors;
+    for (const Case& c : cases) {
+        Result r = evaluate(c);
+        overall.add(r, minIou);
+        byTheme[c.theme].add(r, minIou);
+        byDpr[c.dpr].add(r, minIou);
+        if (r.lineError >= 0.0 && r.iou >= minIou)
+            lineErrors.append(r.lineError);
+        if (r.iou < minIou)
+            out << "  miss " << c.name << " (" << c.theme << ", dpr " << c.dpr << "): IoU "
+                << QString::number(r.iou, 'f', 3) << "\n";
+        if (csvStream.device())
+            csvStream << c.name << ',' << c.theme << ',' << c.dpr << ',' << r.iou << ','
+                      << r.lineError << ',' << r.ms << '\n';
+    }
+
+    out << "overall       " << overall.line() << "\n";
+    for (auto it = byTheme.cbegin(); it != byTheme.cend(); ++it)
+        out << QString("theme %1").arg(it.key(), -8) << it.value().line() << "\n";
+    for (auto it = byDpr.cbegin(); it != byDpr.cend(); ++it)
+        out << QString("dpr %1").arg(it.key(), -10) << it.value().line() << "\n";
+    if (!lineErrors.isEmpty()) {
+        std::sort(lineErrors.begin(), lineErrors.end());
+        out << QString("grid lines    median error %1 px, worst %2 px (logical)\n")
+                   .arg(lineErrors[lineErrors.size() / 2], 0, 'f', 2)
+                   .arg(lineErrors.last(), 0, 'f', 2);
+    }
+    out.flush();
+
+    double hitRate = double(overall.hits) / overall.count;
+    return hitRate >= parser.value(minHitRateOption).toDouble() ? 0 : 1;
+}
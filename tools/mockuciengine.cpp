@@ -0,0 +1,237 @@
+// Deterministic stand-in for a UCI engine.
+//
+// Answers the UCI handshake and, for every "go", streams "info" lines and a
+// final "bestmove" at a fixed rate. The content depends only on the position
+// and the options, never on timing, so parser throughput and UI update
+// coalescing can be stress-tested reproducibly without a real engine.
+//
+// Usage: MockUciEngine [--rate LINES_PER_SEC] [--depth N] [--script FILE]
+//   --rate    info lines per second, 0 = as fast as possible (default 200)
+//   --depth   depth used when "go" has none (default 20)
+//   --script  replay FILE's lines verbatim for every "go" instead of the
+//             generated stream ("bestmove" lines included)
+
+#include "../chessposition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::mutex outputMutex;
+
+void emitLine(const std::string &line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << '\n' << std::flush;
+}
+
+uint64_t fnv1a(const std::string &s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+struct Options {
+    double rate = 200.0;
+    int defaultDepth = 20;
+    std::vector<std::string> script;
+};
+
+class MockEngine
+{
+public:
+    explicit MockEngine(const Options &opts) : options(opts) {
+        position.setFromFen(ChessPosition::startFen());
+    }
+
+    ~MockEngine() { stopSearch(); }
+
+    void handle(const std::string &line) {
+        std::istringstream in(line);
+        std::string cmd;
+        in >> cmd;
+
+        if (cmd == "uci") {
+            emitLine("id name MockUciEngine");
+            emitLine("id author ChessGUI");
+            emitLine("option name MultiPV type spin default 1 min 1 max 64");
+            emitLine("option name Threads type spin default 1 min 1 max 512");
+            emitLine("uciok");
+        } else if (cmd == "isready") {
+            emitLine("readyok");
+        } else if (cmd == "ucinewgame") {
+            stopSearch();
+            position.setFromFen(ChessPosition::startFen());
+        } else if (cmd == "setoption") {
+            std::string word, name, value;
+            in >> word >> name >> word >> value;  // name <id> value <x>
+            if (name == "MultiPV")
+                multiPv = std::max(1, std::atoi(value.c_str()));
+        } else if (cmd == "position") {
+            stopSearch();
+            setPosition(in);
+        } else if (cmd == "go") {
+            stopSearch();
+            int depth = options.defaultDepth;
+            std::string word;
+            while (in >> word) {
+                if (word == "depth")
+                    in >> depth;
+            }
+            startSearch(depth);
+        } else if (cmd == "stop") {
+            stopSearch();
+        }
+    }
+
+private:
+    Options options;
+    ChessPosition position;
+    int multiPv = 1;
+    std::thread worker;
+    std::atomic<bool> stopRequested{false};
+
+    void setPosition(std::istringstream &in) {
+        std::string word;
+        in >> word;
+        if (word == "startpos") {
+            position.setFromFen(ChessPosition::startFen());
+            in >> word;  // "moves" or nothing
+        } else if (word == "fen") {
+            std::string fen, part;
+            while (in >> part && part != "moves")
+                fen += (fen.empty() ? "" : " ") + part;
+            if (!position.setFromFen(fen))
+                position.setFromFen(ChessPosition::startFen());
+        }
+        std::string uci;
+        while (in >> uci) {
+            ChessMove m = position.parseUciMove(uci);
+            if (m.isNull())
+                break;
+            position.makeMove(m);
+        }
+    }
+
+    void startSearch(int depth) {
+        stopRequested = false;
+        // The worker gets its own copy so a new "position" can't race it.
+        worker = std::thread(&MockEngine::search, this, position, depth, multiPv);
+    }
+
+    void stopSearch() {
+        stopRequested = true;
+        if (worker.joinable())
+            worker.join();
+    }
+
+    void pace() const {
+        if (options.rate > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / options.rate));
+    }
+
+    void search(ChessPosition pos, int depth, int lines) {
+        if (!options.script.empty()) {
+            for (const std::string &line : options.script) {
+                if (stopRequested && line.rfind("bestmove", 0) != 0)
+                    continue;
+                emitLine(line);
+                pace();
+            }
+            return;
+        }
+
+        ChessMoveList legal;
+        pos.generateLegalMoves(legal);
+        if (legal.isEmpty()) {
+            emitLine(pos.inCheck() ? "info depth 0 score mate 0" : "info depth 0 score cp 0");
+            emitLine("bestmove (none)");
+            return;
+        }
+
+        const uint64_t seed = fnv1a(pos.fen());
+        lines = std::min(lines, legal.size());
+        std::string best = ChessPosition::moveToUci(legal.moves[seed % uint64_t(legal.size())]);
+        uint64_t nodes = 0;
+
+        for (int d = 1; d <= depth && !stopRequested; ++d) {
+            for (int k = 0; k < lines && !stopRequested; ++k) {
+                // Candidate k is a fixed legal move; its score drifts with depth.
+                int idx = int((seed + uint64_t(k) * 7919) % uint64_t(legal.size()));
+                int base = int(seed % 200) - 100;
+                int score = base - k * 15 + int((seed >> (d % 32)) % 21) - 10;
+                nodes += uint64_t(1000) << std::min(d, 20);
+
+                std::string pv = ChessPosition::moveToUci(legal.moves[idx]);
+                ChessPosition line = pos;
+                line.makeMove(legal.moves[idx]);
+                for (int ply = 1; ply < std::min(d, 8); ++ply) {
+                    ChessMoveList replies;
+                    line.generateLegalMoves(replies);
+                    if (replies.isEmpty())
+                        break;
+                    const ChessMove &reply = replies.moves[(seed + uint64_t(ply)) % uint64_t(replies.size())];
+                    pv += ' ' + ChessPosition::moveToUci(reply);
+                    line.makeMove(reply);
+                }
+
+                std::ostringstream info;
+                info << "info depth " << d << " seldepth " << d + 2 << " multipv " << k + 1
+                     << " score cp " << score << " nodes " << nodes << " nps " << 1000000
+                     << " time " << d * 10 << " pv " << pv;
+                emitLine(info.str());
+                pace();
+            }
+        }
+        emitLine("bestmove " + best);
+    }
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rate" && i + 1 < argc) {
+            options.rate = std::atof(argv[++i]);
+        } else if (arg == "--depth" && i + 1 < argc) {
+            options.defaultDepth = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--script" && i + 1 < argc) {
+            std::ifstream file(argv[++i]);
+            std::string line;
+            while (std::getline(file, line)) {
+                if (!line.empty())
+                    options.script.push_back(line);
+            }
+        } else {
+            std::cerr << "Usage: MockUciEngine [--rate LINES_PER_SEC] [--depth N] [--script FILE]\n";
+            return 2;
+        }
+    }
+
+    std::ios::sync_with_stdio(false);
+    MockEngine engine(options);
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line == "quit")
+            break;
+        engine.handle(line);
+    }
+    return 0;
+}
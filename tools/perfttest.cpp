@@ -0,0 +1,98 @@
+// Move generator check: perft node counts of the standard reference
+// positions (start position, Kiwipete and positions 3 to 6 of the
+// Chess Programming Wiki's perft results) must match exactly. Any change to
+// ChessPosition's move generation, makeMove or unmakeMove should keep this
+// passing; it runs as the "perft" test under ctest.
+//
+// Usage: PerftTest [--max-depth N]
+//   --max-depth  skip expected counts deeper than N (default: all of them)
+
+#include "../chessposition.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PerftCase {
+    const char *name;
+    const char *fen;
+    std::vector<uint64_t> nodes;  // depth 1, 2, ...
+};
+
+const std::vector<PerftCase> &referenceCases() {
+    static const std::vector<PerftCase> cases = {
+        { "start position",
+          "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+          { 20, 400, 8902, 197281, 4865609 } },
+        { "Kiwipete",
+          "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          { 48, 2039, 97862, 4085603 } },
+        { "position 3",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+          { 14, 191, 2812, 43238, 674624 } },
+        { "position 4",
+          "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+          { 6, 264, 9467, 422333 } },
+        { "position 4 mirrored",
+          "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+          { 6, 264, 9467, 422333 } },
+        { "position 5",
+          "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+          { 44, 1486, 62379, 2103487 } },
+        { "position 6",
+          "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+          { 46, 2079, 89890, 3894594 } },
+    };
+    return cases;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int maxDepth = 99;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-depth" && i + 1 < argc) {
+            maxDepth = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: PerftTest [--max-depth N]\n";
+            return 2;
+        }
+    }
+
+    int failures = 0;
+    const auto started = std::chrono::steady_clock::now();
+    for (const PerftCase &c : referenceCases()) {
+        ChessPosition position;
+        if (!position.setFromFen(c.fen)) {
+            std::cout << "FAIL " << c.name << ": FEN rejected\n";
+            ++failures;
+            continue;
+        }
+        for (int depth = 1; depth <= int(c.nodes.size()) && depth <= maxDepth; ++depth) {
+            const uint64_t expected = c.nodes[depth - 1];
+            const uint64_t nodes = position.perft(depth);
+            if (nodes != expected) {
+                std::cout << "FAIL " << c.name << " depth " << depth << ": " << nodes
+                          << " nodes, expected " << expected << "\n";
+                ++failures;
+                break;
+            }
+            std::cout << "ok   " << c.name << " depth " << depth << ": " << nodes << "\n";
+        }
+        // perft must leave the position as it found it.
+        if (position.fen() != c.fen) {
+            std::cout << "FAIL " << c.name << ": position changed to " << position.fen() << "\n";
+            ++failures;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << (failures ? "perft: FAILED" : "perft: all counts match") << " (" << seconds << " s)\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+// Cost of moving positions around the GUI: the QString FEN path the
+// recognizer handler used to take on every frame against the PackedPosition
+// path it takes now, plus each conversion on its own.
+//
+// The corpus is a set of positions from seeded random games. Every case runs
+// over the whole corpus --rounds times; the best round is reported in
+// nanoseconds per position, so a noisy machine inflates nothing.
+//
+// Usage: PositionBench [--count N] [--rounds R] [--seed S]
+//   --count   positions in the corpus (default 4096)
+//   --rounds  passes per case, best one reported (default 20)
+//   --seed    corpus seed, same seed = same positions (default 1)
+
+#include "../chessposition.h"
+#include "../packedposition.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace {
+
+// Defeats dead-code elimination of the measured work.
+volatile uint64_t sink = 0;
+
+QVector<PackedPosition> randomPositions(int count, quint32 seed) {
+    QRandomGenerator rng(seed);
+    QVector<PackedPosition> out;
+    out.reserve(count);
+    ChessPosition position;
+    position.setFromFen(ChessPosition::startFen());
+    while (out.size() < count) {
+        ChessMoveList moves;
+        position.generateLegalMoves(moves);
+        if (moves.isEmpty() || position.halfmoveClock() >= 100 || position.fullmoveNumber() > 150) {
+            position.setFromFen(ChessPosition::startFen());
+            continue;
+        }
+        position.makeMove(moves.moves[rng.bounded(moves.size())]);
+        out.append(position.packed());
+    }
+    return out;
+}
+
+double bestNsPerItem(int rounds, int items, const std::function<void()> &pass) {
+    double best = std::numeric_limits<double>::max();
+    QElapsedTimer timer;
+    for (int r = 0; r < rounds; ++r) {
+        timer.start();
+        pass();
+        best = qMin(best, double(timer.nsecsElapsed()) / items);
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption countOption("count", "Positions in the corpus.", "n", "4096");
+    QCommandLineOption roundsOption("rounds", "Passes per case; the best is reported.", "n", "20");
+    QCommandLineOption seedOption("seed", "Corpus seed.", "n", "1");
+    parser.addOptions({countOption, roundsOption, seedOption});
+    parser.process(app);
+
+    const int count = qMax(2, parser.value(countOption).toInt());
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+    const QVector<PackedPosition> packed = randomPositions(count, parser.value(seedOption).toUInt());
+
+    QStringList fens;
+    std::vector<std::string> stdFens;
+    QVector<ChessPosition> positions(count);
+    for (int i = 0; i < count; ++i) {
+        stdFens.push_back(packed[i].fen());
+        fens << QString::fromStdString(stdFens.back());
+        positions[i].setFromPacked(packed[i]);
+    }
+
+    QTextStream out(stdout);
+    auto report = [&out](const char *name, double ns) {
+        out << QString("%1 %2 ns\n").arg(QLatin1String(name), -44).arg(ns, 9, 'f', 1);
+        out.flush();
+    };
+
+    out << count << " positions, best of " << rounds << " rounds\n\n";
+
+    // What the recognizer handler did per frame: split the QString FEN,
+    // parse it for the game, parse the placement again for the board and
+    // compare against the previous FEN.
+    const double before = bestNsPerItem(rounds, count, [&]() {
+        ChessPosition position;
+        uint8_t grid[64];
+        for (int i = 1; i < count; ++i) {
+            const QString &fen = fens.at(i);
+            QString placement = fen.section(' ', 0, 0);
+            QString turn = fen.section(' ', 1, 1);
+            position.setFromFen(fen.toStdString());
+            ChessPosition::parsePlacement(placement.toStdString(), grid);
+            sink += grid[i & 63] + (turn == QLatin1String("b")) + (fen != fens.at(i - 1));
+        }
+    });
+    // The same steps on the packed type.
+    const double after = bestNsPerItem(rounds, count, [&]() {
+        ChessPosition position;
+        uint8_t grid[64];
+        for (int i = 1; i < count; ++i) {
+            const PackedPosition p = packed[i];
+            position.setFromPacked(p);
+            p.unpack(grid);
+            sink += grid[i & 63] + p.side + (p != packed[i - 1]);
+        }
+    });
+    report("per frame, QString FEN (before)", before);
+    report("per frame, PackedPosition (now)", after);
+    out << QString("%1 %2x\n\n").arg(QLatin1String("speedup"), -44).arg(before / after, 9, 'f', 1);
+
+    report("ChessPosition::setFromFen", bestNsPerItem(rounds, count, [&]() {
+        ChessPosition position;
+        for (const std::string &fen : stdFens) {
+            position.setFromFen(fen);
+            sink += position.pieceAt(4);
+        }
+    }));
+    report("ChessPosition::setFromPacked", bestNsPerItem(rounds, count, [&]() {
+        ChessPosition position;
+        for (const PackedPosition &p : packed) {
+            position.setFromPacked(p);
+            sink += position.pieceAt(4);
+        }
+    }));
+    report("ChessPosition::packed", bestNsPerItem(rounds, count, [&]() {
+        for (const ChessPosition &position : positions)
+            sink += position.packed().squares[2];
+    }));
+    report("PackedPosition::fromFen", bestNsPerItem(rounds, count, [&]() {
+        PackedPosition p;
+        for (const std::string &fen : stdFens) {
+            PackedPosition::fromFen(fen, p);
+            sink += p.squares[2];
+        }
+    }));
+    report("PackedPosition::fen (UCI boundary)", bestNsPerItem(rounds, count, [&]() {
+        for (const PackedPosition &p : packed)
+            sink += p.fen().size();
+    }));
+    report("QString::fromStdString(fen()) (display)", bestNsPerItem(rounds, count, [&]() {
+        for (const PackedPosition &p : packed)
+            sink += QString::fromStdString(p.fen()).size();
+    }));
+    report("PackedPosition::unpack", bestNsPerItem(rounds, count, [&]() {
+        uint8_t grid[64];
+        for (const PackedPosition &p : packed) {
+            p.unpack(grid);
+            sink += grid[4];
+        }
+    }));
+    report("PackedPosition == (previous)", bestNsPerItem(rounds, count, [&]() {
+        for (int i = 1; i < count; ++i)
+            sink += packed[i] == packed[i - 1];
+    }));
+    report("QString FEN == (previous)", bestNsPerItem(rounds, count, [&]() {
+        for (int i = 1; i < count; ++i)
+            sink += fens.at(i) == fens.at(i - 1);
+    }));
+
+    // Round trips must be lossless, or the numbers above compare different work.
+    for (int i = 0; i < count; ++i) {
+        PackedPosition viaFen;
+        if (!PackedPosition::fromFen(stdFens[i], viaFen) || viaFen != packed[i]
+            || positions[i].packed() != packed[i]) {
+            out << "Round trip mismatch at " << fens.at(i) << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}